@@ -0,0 +1,12 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <cstdint>
+
+/**
+ * @brief number of operator new calls since program start; counted only
+ * in builds with COUNT_ALLOCS (make allocs), always 0 otherwise
+ */
+uint64_t allocationCount();
+
+#endif // ALLOC_H
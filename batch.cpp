@@ -0,0 +1,270 @@
+#include "batch.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+/**
+ * @brief options: depth=<N> movetime=<ms> nodes=<N> (per position, depth 8
+ * if none is given), workers=<N> (default: one per core), format=csv|json,
+ * out=<file>; other flags (hash=, nonull, ...) go to every worker's Engine
+ */
+Batch::Batch(const std::vector<std::string> &args)
+{
+    workers = std::max(1u, std::thread::hardware_concurrency());
+    for (const auto &arg : args)
+    {
+        if (arg.rfind("depth=", 0) == 0)
+            limits.depth = std::stoi(arg.substr(6));
+        else if (arg.rfind("movetime=", 0) == 0)
+            limits.movetime = std::stoi(arg.substr(9));
+        else if (arg.rfind("nodes=", 0) == 0)
+            limits.nodes = std::stoull(arg.substr(6));
+        else if (arg.rfind("workers=", 0) == 0)
+            workers = std::max(1, std::stoi(arg.substr(8)));
+        else if (arg == "format=json")
+            json = true;
+        else if (arg.rfind("out=", 0) == 0)
+            out_path = arg.substr(4);
+        else
+            engine_flags.push_back(arg);
+    }
+    if (!limits.depth && !limits.movetime && !limits.nodes)
+        limits.depth = 8;
+}
+
+/**
+ * @brief split an input line into the position and its EPD id; accepts
+ * plain FENs (with or without move counters) and EPD lines with operations
+ * @return false for blank lines and comments
+ */
+bool Batch::parseLine(const std::string &line, std::string &fen, std::string &id)
+{
+    std::istringstream is(line);
+    std::vector<std::string> fields;
+    std::string field;
+    while (is >> field)
+        fields.push_back(field);
+    if (fields.size() < 4 || fields[0][0] == '#')
+        return false;
+
+    // move counters are numbers, EPD operations are not
+    size_t count = 4;
+    while (count < fields.size() && count < 6 &&
+           std::all_of(fields[count].begin(), fields[count].end(), ::isdigit))
+        count++;
+    fen = fields[0];
+    for (size_t i = 1; i < count; i++)
+        fen += " " + fields[i];
+
+    id.clear();
+    size_t pos = line.find("id \"");
+    if (pos != std::string::npos)
+    {
+        size_t end = line.find('"', pos + 4);
+        if (end != std::string::npos)
+            id = line.substr(pos + 4, end - pos - 4);
+    }
+    return true;
+}
+
+static std::string jsonString(const std::string &text)
+{
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+static std::string csvField(const std::string &text)
+{
+    if (text.find_first_of(",\"") == std::string::npos)
+        return text;
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"')
+            quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+/**
+ * @brief one output row; score is in centipawns from the side on move,
+ * mate is the number of moves to a forced mate (negative: getting mated, 0: none).
+ * A side on move that is already checkmated has no score and no mate, and
+ * "checkmated" in the error field instead.
+ */
+std::string Batch::row(const Job &job, const SearchThread &result, double ms) const
+{
+    bool mated = result.pv.empty() && result.score == -MATE;
+    std::string move = result.pv.empty() ? "0000" : Board::descUci(result.pv[0]);
+    int mate = Engine::isMateScore(result.score) ? Engine::mateMoves(result.score) : 0;
+    int score = mate ? 0 : result.score;
+    std::ostringstream os;
+    if (json)
+    {
+        os << "{\"index\": " << job.index << ", \"id\": " << jsonString(job.id)
+           << ", \"fen\": " << jsonString(job.fen) << ", \"bestmove\": \"" << move << "\", \"score\": ";
+        if (mated)
+            os << "null, \"mate\": null";
+        else
+            os << score << ", \"mate\": " << mate;
+        os << ", \"depth\": " << result.depth << ", \"nodes\": " << result.nodes << ", \"time_ms\": " << ms;
+        if (mated)
+            os << ", \"error\": \"checkmated\"";
+        os << "}";
+    }
+    else
+    {
+        os << job.index << "," << csvField(job.id) << "," << csvField(job.fen) << "," << move << ",";
+        if (!mated)
+            os << score << "," << mate;
+        else
+            os << ",";
+        os << "," << result.depth << "," << result.nodes << "," << ms << "," << (mated ? "checkmated" : "");
+    }
+    return os.str();
+}
+
+/**
+ * @brief row of a position that could not be analysed: no move, only the error
+ */
+std::string Batch::errorRow(const Job &job, const std::string &error) const
+{
+    std::ostringstream os;
+    if (json)
+    {
+        os << "{\"index\": " << job.index << ", \"id\": " << jsonString(job.id)
+           << ", \"fen\": " << jsonString(job.fen) << ", \"bestmove\": \"\", \"error\": " << jsonString(error)
+           << "}";
+    }
+    else
+    {
+        os << job.index << "," << csvField(job.id) << "," << csvField(job.fen) << ",,,,,,," << csvField(error);
+    }
+    return os.str();
+}
+
+/**
+ * @brief hand a finished row over; rows go out as soon as every earlier
+ * one has been written
+ */
+void Batch::write(size_t index, std::string row)
+{
+    std::lock_guard<std::mutex> lock(out_mutex);
+    pending.emplace(index, std::move(row));
+    for (auto it = pending.begin(); it != pending.end() && it->first == next_row; it = pending.erase(it))
+    {
+        *out << it->second << "\n";
+        next_row++;
+    }
+}
+
+void Batch::worker()
+{
+    // the engine keeps one search thread; the pool parallelizes over positions
+    std::vector<std::string> flags = engine_flags;
+    flags.push_back("threads=1");
+    Engine engine("", flags);
+
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cv.wait(lock, [&] { return !queue.empty() || !reading; });
+            if (queue.empty())
+                return;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+        queue_cv.notify_all();
+
+        auto start = std::chrono::steady_clock::now();
+        try
+        {
+            Board bd(job.fen);
+            engine.clearHash(); // rows must not depend on which positions a worker saw before
+            engine.setPosition(bd);
+            engine.startSearch(limits);
+            const SearchThread &result = engine.finishSearch();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            write(job.index, row(job, result, ms));
+        }
+        catch (const std::exception &e)
+        {
+            // a bad line costs its own row only, the others keep their place
+            std::cerr << "position " << job.index << " (" << job.fen << "): " << e.what() << "\n";
+            write(job.index, errorRow(job, e.what()));
+        }
+    }
+}
+
+/**
+ * @brief analyse every position of the file; the throughput summary goes
+ * to stderr so that stdout holds only rows
+ * @return 0 on success, 1 if a file cannot be opened
+ */
+int Batch::run(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "cannot open " << path << "\n";
+        return 1;
+    }
+    std::ofstream out_file;
+    if (!out_path.empty())
+    {
+        out_file.open(out_path);
+        if (!out_file)
+        {
+            std::cerr << "cannot write " << out_path << "\n";
+            return 1;
+        }
+        out = &out_file;
+    }
+    if (!json)
+        *out << "index,id,fen,bestmove,score,mate,depth,nodes,time_ms,error\n";
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int i = 0; i < workers; i++)
+        pool.emplace_back(&Batch::worker, this);
+
+    size_t count = 0;
+    std::string line, fen, id;
+    while (std::getline(file, line))
+    {
+        if (!parseLine(line, fen, id))
+            continue;
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_cv.wait(lock, [&] { return queue.size() < static_cast<size_t>(4 * workers); });
+        queue.push_back({count++, fen, id});
+        lock.unlock();
+        queue_cv.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        reading = false;
+    }
+    queue_cv.notify_all();
+    for (auto &thread : pool)
+        thread.join();
+    out->flush();
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "positions: " << count << "\n";
+    std::cerr << "workers  : " << workers << "\n";
+    std::cerr << "time     : " << elapsed << " s" << "\n";
+    std::cerr << "pos/s    : " << count / std::max(elapsed, 1e-9) << "\n";
+    return 0;
+}
@@ -0,0 +1,56 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+#include "engine.h"
+
+/**
+ * Offline analysis of an EPD/FEN file: positions are streamed to a pool of
+ * workers, each with its own Engine, and written back as one CSV or JSON
+ * row per position in input order.
+ */
+class Batch {
+private:
+    struct Job {
+        size_t index;
+        std::string fen;
+        std::string id; // EPD id operation, empty if there is none
+    };
+
+    std::vector<std::string> engine_flags;
+    SearchLimits limits;
+    int workers;
+    bool json = false;
+    std::string out_path; // empty: stdout
+    std::ostream *out = &std::cout;
+
+    // positions read but not yet taken, bounded so the file is streamed
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<Job> queue;
+    bool reading = true;
+
+    // rows finished out of order wait here until their turn
+    std::mutex out_mutex;
+    std::map<size_t, std::string> pending;
+    size_t next_row = 0;
+
+    static bool parseLine(const std::string &line, std::string &fen, std::string &id);
+    void worker();
+    std::string row(const Job &job, const SearchThread &result, double ms) const;
+    std::string errorRow(const Job &job, const std::string &error) const;
+    void write(size_t index, std::string row);
+
+public:
+    explicit Batch(const std::vector<std::string> &args);
+
+    int run(const std::string &path);
+};
+
+#endif // BATCH_H
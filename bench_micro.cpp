@@ -0,0 +1,397 @@
+#include "board.h"
+#include "pawns.h"
+#include "alloc.h"
+#include "positions.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Microbenchmarks of the Board hot paths on a fixed set of positions.
+ *
+ *   bench_micro [--json] [--compare <baseline.json>] [--threshold <percent>]
+ *
+ * Every benchmark runs REPEATS times and reports the fastest run in ns per
+ * operation, with heap allocations per operation (this binary is linked
+ * with the counting operator new) and, where perf_event_open is allowed,
+ * cycles and instructions per operation. --json prints one JSON object per
+ * benchmark and line; saved to a file it is the baseline for --compare,
+ * which exits with 1 if any benchmark got slower by more than the
+ * threshold (default 10%).
+ */
+
+static constexpr int REPEATS = 5;
+
+uint64_t sink = 0; // external, so the work feeding it is not optimized away
+
+/**
+ * Hardware cycle and instruction counters of this thread, read as one
+ * group. open() fails quietly where perf events are not permitted.
+ */
+class PerfCounters {
+private:
+    int group = -1;
+    int instructions = -1;
+
+#ifdef __linux__
+    static int openEvent(uint64_t config, int group_fd)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = group_fd == -1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+    }
+#endif
+
+public:
+    bool open()
+    {
+#ifdef __linux__
+        group = openEvent(PERF_COUNT_HW_CPU_CYCLES, -1);
+        if (group >= 0)
+            instructions = openEvent(PERF_COUNT_HW_INSTRUCTIONS, group);
+        if (instructions < 0 && group >= 0)
+        {
+            ::close(group);
+            group = -1;
+        }
+#endif
+        return group >= 0;
+    }
+
+    ~PerfCounters()
+    {
+#ifdef __linux__
+        if (instructions >= 0)
+            ::close(instructions);
+        if (group >= 0)
+            ::close(group);
+#endif
+    }
+
+    bool available() const { return group >= 0; }
+
+    void start()
+    {
+#ifdef __linux__
+        if (group < 0)
+            return;
+        ioctl(group, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(group, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    void stop(uint64_t &cycles, uint64_t &instrs)
+    {
+        cycles = instrs = 0;
+#ifdef __linux__
+        if (group < 0)
+            return;
+        ioctl(group, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        uint64_t values[3] = {0, 0, 0}; // count, cycles, instructions
+        if (read(group, values, sizeof(values)) == sizeof(values))
+        {
+            cycles = values[1];
+            instrs = values[2];
+        }
+#endif
+    }
+};
+
+struct Result {
+    std::string name;
+    double ns_per_op;
+    double allocs_per_op;
+    double cycles_per_op;       // negative: not measured
+    double instructions_per_op;
+};
+
+/**
+ * @brief run a benchmark REPEATS times and keep its fastest run
+ * @param body one pass, returns the number of operations it performed
+ */
+static Result measure(const std::string &name, PerfCounters &perf, const std::function<uint64_t()> &body)
+{
+    body(); // warm up caches and branch predictors
+    Result best = {name, 1e300, 0, -1, -1};
+    for (int r = 0; r < REPEATS; r++)
+    {
+        uint64_t allocs = allocationCount();
+        perf.start();
+        auto start = std::chrono::steady_clock::now();
+        uint64_t ops = body();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        uint64_t cycles, instrs;
+        perf.stop(cycles, instrs);
+        allocs = allocationCount() - allocs;
+
+        if (ns / ops < best.ns_per_op)
+        {
+            best.ns_per_op = ns / ops;
+            best.allocs_per_op = double(allocs) / ops;
+            if (perf.available())
+            {
+                best.cycles_per_op = double(cycles) / ops;
+                best.instructions_per_op = double(instrs) / ops;
+            }
+        }
+    }
+    return best;
+}
+
+static std::vector<Result> runAll()
+{
+    PerfCounters perf;
+    perf.open();
+
+    std::vector<Board> boards;
+    std::vector<MoveList> legal(std::size(SAMPLE_FENS));
+    for (size_t i = 0; i < std::size(SAMPLE_FENS); i++)
+    {
+        boards.emplace_back(SAMPLE_FENS[i]);
+        boards[i].allMoves(legal[i]);
+    }
+    // every position one legal move away, for eval on varied positions
+    std::vector<Board> children;
+    for (size_t i = 0; i < boards.size(); i++)
+    {
+        for (Move move : legal[i])
+        {
+            children.push_back(boards[i]);
+            children.back().movePiece(move);
+        }
+    }
+    PawnTable pawns;
+    std::vector<Result> results;
+
+    results.push_back(measure("allMoves", perf, [&] {
+        uint64_t ops = 0;
+        for (int r = 0; r < 20000; r++)
+        {
+            for (Board &bd : boards)
+            {
+                MoveList moves;
+                bd.allMoves(moves);
+                sink += moves.size();
+                ops++;
+            }
+        }
+        return ops;
+    }));
+    results.push_back(measure("movePiece+undoMove", perf, [&] {
+        uint64_t ops = 0;
+        for (int r = 0; r < 2000; r++)
+        {
+            for (size_t i = 0; i < boards.size(); i++)
+            {
+                for (Move move : legal[i])
+                {
+                    boards[i].movePiece(move);
+                    boards[i].undoMove();
+                    ops++;
+                }
+            }
+        }
+        sink += boards[0].getKey();
+        return ops;
+    }));
+    results.push_back(measure("isCheck", perf, [&] {
+        uint64_t ops = 0;
+        for (int r = 0; r < 200000; r++)
+        {
+            for (Board &bd : boards)
+            {
+                sink += bd.isCheck();
+                ops++;
+            }
+        }
+        return ops;
+    }));
+    results.push_back(measure("eval", perf, [&] {
+        uint64_t ops = 0;
+        for (int r = 0; r < 2000; r++)
+        {
+            for (Board &bd : children)
+            {
+                sink += bd.eval(pawns);
+                ops++;
+            }
+        }
+        return ops;
+    }));
+    results.push_back(measure("readFen", perf, [&] {
+        uint64_t ops = 0;
+        Board bd;
+        for (int r = 0; r < 20000; r++)
+        {
+            for (const char *fen : SAMPLE_FENS)
+            {
+                bd.readFen(fen);
+                sink += bd.getKey();
+                ops++;
+            }
+        }
+        return ops;
+    }));
+    results.push_back(measure("descMove", perf, [&] {
+        uint64_t ops = 0;
+        for (int r = 0; r < 2000; r++)
+        {
+            for (const MoveList &moves : legal)
+            {
+                for (Move move : moves)
+                {
+                    sink += Board::descMove(move).size();
+                    ops++;
+                }
+            }
+        }
+        return ops;
+    }));
+    return results;
+}
+
+static void printJson(const std::vector<Result> &results)
+{
+    for (const Result &res : results)
+    {
+        std::cout << "{\"name\": \"" << res.name << "\", \"ns_per_op\": " << res.ns_per_op
+                  << ", \"allocs_per_op\": " << res.allocs_per_op;
+        if (res.cycles_per_op >= 0)
+            std::cout << ", \"cycles_per_op\": " << res.cycles_per_op
+                      << ", \"instructions_per_op\": " << res.instructions_per_op;
+        else
+            std::cout << ", \"cycles_per_op\": null, \"instructions_per_op\": null";
+        std::cout << "}\n";
+    }
+}
+
+static void printTable(const std::vector<Result> &results)
+{
+    std::cout << std::left << std::setw(20) << "benchmark" << std::right << std::setw(10) << "ns/op"
+              << std::setw(12) << "allocs/op" << std::setw(12) << "cycles/op" << std::setw(12) << "instr/op"
+              << std::setw(8) << "IPC" << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+    for (const Result &res : results)
+    {
+        std::cout << std::left << std::setw(20) << res.name << std::right << std::setw(10) << res.ns_per_op
+                  << std::setw(12) << res.allocs_per_op;
+        if (res.cycles_per_op >= 0)
+            std::cout << std::setw(12) << res.cycles_per_op << std::setw(12) << res.instructions_per_op
+                      << std::setw(8) << res.instructions_per_op / std::max(res.cycles_per_op, 1e-9);
+        else
+            std::cout << std::setw(12) << "n/a" << std::setw(12) << "n/a" << std::setw(8) << "n/a";
+        std::cout << "\n";
+    }
+}
+
+/**
+ * @brief ns/op by benchmark name from a file written with --json
+ */
+static std::map<std::string, double> readBaseline(const std::string &path)
+{
+    std::map<std::string, double> baseline;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        size_t name = line.find("\"name\": \"");
+        size_t ns = line.find("\"ns_per_op\": ");
+        if (name == std::string::npos || ns == std::string::npos)
+            continue;
+        name += 9;
+        baseline[line.substr(name, line.find('"', name) - name)] = std::stod(line.substr(ns + 13));
+    }
+    return baseline;
+}
+
+/**
+ * @brief compare ns/op against a baseline
+ * @return number of benchmarks slower than the baseline by more than threshold percent
+ */
+static int compare(const std::vector<Result> &results, const std::map<std::string, double> &baseline, double threshold,
+                   std::ostream &os)
+{
+    int regressions = 0;
+    os << std::fixed << std::setprecision(2);
+    for (const Result &res : results)
+    {
+        auto it = baseline.find(res.name);
+        if (it == baseline.end())
+        {
+            os << std::left << std::setw(20) << res.name << " not in baseline\n";
+            continue;
+        }
+        double change = (res.ns_per_op - it->second) / it->second * 100;
+        bool regressed = change > threshold;
+        regressions += regressed;
+        os << std::left << std::setw(20) << res.name << std::right << std::setw(10) << it->second << " -> "
+           << std::setw(10) << res.ns_per_op << " ns/op " << std::showpos << std::setw(8) << change
+           << std::noshowpos << "%" << (regressed ? "  REGRESSION" : "") << "\n";
+    }
+    return regressions;
+}
+
+int main(int argc, char *argv[])
+{
+    bool json = false;
+    std::string baseline_path;
+    double threshold = 10;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--json")
+            json = true;
+        else if (arg == "--compare" && i + 1 < argc)
+            baseline_path = argv[++i];
+        else if (arg == "--threshold" && i + 1 < argc)
+            threshold = std::stod(argv[++i]);
+        else
+        {
+            std::cerr << "usage: bench_micro [--json] [--compare <baseline.json>] [--threshold <percent>]\n";
+            return 2;
+        }
+    }
+
+    initAttacks();
+    std::vector<Result> results = runAll();
+    if (json)
+        printJson(results);
+    else
+        printTable(results);
+
+    if (baseline_path.empty())
+        return 0;
+    std::map<std::string, double> baseline = readBaseline(baseline_path);
+    if (baseline.empty())
+    {
+        std::cerr << "no baseline results in " << baseline_path << "\n";
+        return 2;
+    }
+    std::ostream &out = json ? std::cerr : std::cout; // keep --json output parseable
+    int regressions = compare(results, baseline, threshold, out);
+    if (regressions)
+        out << regressions << " benchmark(s) slower than the baseline by more than " << threshold << "%\n";
+    return regressions ? 1 : 0;
+}
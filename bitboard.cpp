@@ -0,0 +1,75 @@
+#include "bitboard.h"
+#include "magics.h"
+#include <cassert>
+#include <chrono>
+
+Magic BISHOP_MAGICS[64];
+Magic ROOK_MAGICS[64];
+Bitboard BETWEEN[64][64];
+Bitboard LINE[64][64];
+
+static Bitboard BISHOP_TABLE[0x1480];
+static Bitboard ROOK_TABLE[0x19000];
+
+/**
+ * @brief point every square at its slice of the shared table and fill it;
+ * with magics from magics.h no two occupancies with different attacks
+ * share an entry
+ */
+static void initMagics(Magic magics[64], Bitboard *table, const Bitboard numbers[64],
+                       Bitboard (*attacks)(Bitboard, Bitboard))
+{
+    for (int sq = 0; sq < 64; sq++)
+    {
+        Magic &m = magics[sq];
+        m.mask = relevantMask(sq, attacks);
+        m.magic = numbers[sq];
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = sq == 0 ? table : magics[sq - 1].attacks + (1 << (64 - magics[sq - 1].shift));
+
+        // every subset of the mask (carry-rippler)
+        Bitboard b = 0;
+        do
+        {
+            Bitboard reached = attacks(squareBB(sq), b);
+            Bitboard &entry = m.attacks[m.index(b)];
+            assert(entry == 0 || entry == reached); // a slider always attacks something
+            entry = reached;
+            b = (b - m.mask) & m.mask;
+        } while (b);
+    }
+}
+
+static void initLines()
+{
+    for (int a = 0; a < 64; a++)
+    {
+        for (int b = 0; b < 64; b++)
+        {
+            BETWEEN[a][b] = LINE[a][b] = 0;
+            Bitboard ab = squareBB(a) | squareBB(b);
+            if (a == b)
+                continue;
+            if (rookAttacks(a, 0) & squareBB(b))
+            {
+                BETWEEN[a][b] = rookAttacks(a, ab) & rookAttacks(b, ab);
+                LINE[a][b] = (rookAttacks(a, 0) & rookAttacks(b, 0)) | ab;
+            }
+            else if (bishopAttacks(a, 0) & squareBB(b))
+            {
+                BETWEEN[a][b] = bishopAttacks(a, ab) & bishopAttacks(b, ab);
+                LINE[a][b] = (bishopAttacks(a, 0) & bishopAttacks(b, 0)) | ab;
+            }
+        }
+    }
+}
+
+double initAttacks()
+{
+    auto start = std::chrono::steady_clock::now();
+    initMagics(BISHOP_MAGICS, BISHOP_TABLE, BISHOP_MAGIC_NUMBERS, bishopAttacksBB);
+    initMagics(ROOK_MAGICS, ROOK_TABLE, ROOK_MAGIC_NUMBERS, rookAttacksBB);
+    initLines();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
@@ -0,0 +1,235 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+#include <array>
+#ifdef USE_PEXT
+#include <immintrin.h>
+#endif
+
+typedef uint64_t Bitboard;
+
+/*
+ * Square numbering follows the Board layout: sq = y * 8 + x
+ * x: 0=A, 7=H; y: 0=8, 7=1 (so bit 0 is A8 and bit 63 is H1)
+ */
+
+enum Piece {
+    PAWN,
+    KNIGHT,
+    BISHOP,
+    ROOK,
+    QUEEN,
+    KING,
+    NO_PIECE
+};
+
+enum Color {
+    BLACK,
+    WHITE
+};
+
+enum Direction {
+    NORTH,
+    SOUTH,
+    EAST,
+    WEST,
+    NORTH_EAST,
+    NORTH_WEST,
+    SOUTH_EAST,
+    SOUTH_WEST
+};
+
+constexpr Bitboard FILE_A = 0x0101010101010101ULL;
+constexpr Bitboard FILE_B = FILE_A << 1;
+constexpr Bitboard FILE_G = FILE_A << 6;
+constexpr Bitboard FILE_H = FILE_A << 7;
+constexpr Bitboard RANK_8 = 0xFFULL;
+constexpr Bitboard RANK_1 = RANK_8 << 56;
+
+constexpr Bitboard squareBB(int sq) { return 1ULL << sq; }
+constexpr Bitboard rankBB(int y) { return RANK_8 << (8 * y); }
+
+inline int popCount(Bitboard b) { return __builtin_popcountll(b); }
+inline int lsb(Bitboard b) { return __builtin_ctzll(b); }
+inline int popLsb(Bitboard &b)
+{
+    int sq = lsb(b);
+    b &= b - 1;
+    return sq;
+}
+
+/**
+ * @brief move every bit of the set one step in the given direction,
+ * dropping bits that would wrap around the A/H files
+ */
+constexpr Bitboard shift(Bitboard b, Direction d)
+{
+    switch (d)
+    {
+    case NORTH:
+        return b >> 8;
+    case SOUTH:
+        return b << 8;
+    case EAST:
+        return (b << 1) & ~FILE_A;
+    case WEST:
+        return (b >> 1) & ~FILE_H;
+    case NORTH_EAST:
+        return (b >> 7) & ~FILE_A;
+    case NORTH_WEST:
+        return (b >> 9) & ~FILE_H;
+    case SOUTH_EAST:
+        return (b << 9) & ~FILE_A;
+    case SOUTH_WEST:
+        return (b << 7) & ~FILE_H;
+    }
+    return 0;
+}
+
+/**
+ * @brief occluded fill: squares reached from every bit of gen sliding in
+ * direction d, stopping on (and including) the first occupied square
+ * @param gen set of sliding pieces
+ * @param empty set of empty squares
+ */
+constexpr Bitboard slide(Bitboard gen, Bitboard empty, Direction d)
+{
+    Bitboard flood = gen;
+    for (int i = 0; i < 6; i++)
+    {
+        gen = shift(gen, d) & empty;
+        flood |= gen;
+    }
+    return shift(flood, d);
+}
+
+constexpr Bitboard knightAttacksBB(Bitboard b)
+{
+    Bitboard l1 = (b >> 1) & ~FILE_H;
+    Bitboard l2 = (b >> 2) & ~(FILE_G | FILE_H);
+    Bitboard r1 = (b << 1) & ~FILE_A;
+    Bitboard r2 = (b << 2) & ~(FILE_A | FILE_B);
+    Bitboard h1 = l1 | r1;
+    Bitboard h2 = l2 | r2;
+    return (h1 << 16) | (h1 >> 16) | (h2 << 8) | (h2 >> 8);
+}
+
+constexpr Bitboard kingAttacksBB(Bitboard b)
+{
+    Bitboard attacks = shift(b, EAST) | shift(b, WEST);
+    b |= attacks;
+    return attacks | shift(b, NORTH) | shift(b, SOUTH);
+}
+
+/**
+ * @brief squares attacked by a set of pawns
+ * @param white true: pawns move north (towards y=0)
+ */
+constexpr Bitboard pawnAttacksBB(Bitboard b, bool white)
+{
+    return white ? shift(b, NORTH_EAST) | shift(b, NORTH_WEST)
+                 : shift(b, SOUTH_EAST) | shift(b, SOUTH_WEST);
+}
+
+constexpr Bitboard bishopAttacksBB(Bitboard b, Bitboard occupied)
+{
+    Bitboard empty = ~occupied;
+    return slide(b, empty, NORTH_EAST) | slide(b, empty, NORTH_WEST) |
+           slide(b, empty, SOUTH_EAST) | slide(b, empty, SOUTH_WEST);
+}
+
+constexpr Bitboard rookAttacksBB(Bitboard b, Bitboard occupied)
+{
+    Bitboard empty = ~occupied;
+    return slide(b, empty, NORTH) | slide(b, empty, SOUTH) |
+           slide(b, empty, EAST) | slide(b, empty, WEST);
+}
+
+/**
+ * @brief occupancy bits that can change a slider's attacks from a square;
+ * the last square of every ray never matters
+ */
+constexpr Bitboard relevantMask(int sq, Bitboard (*attacks)(Bitboard, Bitboard))
+{
+    int x = sq & 7, y = sq >> 3;
+    Bitboard edges = ((RANK_8 | RANK_1) & ~rankBB(y)) | ((FILE_A | FILE_H) & ~(FILE_A << x));
+    return attacks(squareBB(sq), 0) & ~edges;
+}
+
+/*
+ * Per-square attack tables. Knight, king and pawn attacks are built by the
+ * compiler from the set-wise functions above; slider attacks are looked up
+ * through magic (or, with USE_PEXT, BMI2 pext) indices into tables filled
+ * once by initAttacks(). The magic multipliers are constants in magics.h,
+ * found offline by magic_gen.
+ */
+
+constexpr std::array<Bitboard, 64> makeTable(Bitboard (*attacks)(Bitboard))
+{
+    std::array<Bitboard, 64> table{};
+    for (int sq = 0; sq < 64; sq++)
+        table[sq] = attacks(squareBB(sq));
+    return table;
+}
+
+constexpr Bitboard whitePawnAttacksBB(Bitboard b) { return pawnAttacksBB(b, true); }
+constexpr Bitboard blackPawnAttacksBB(Bitboard b) { return pawnAttacksBB(b, false); }
+
+constexpr std::array<Bitboard, 64> KNIGHT_ATTACKS = makeTable(knightAttacksBB);
+constexpr std::array<Bitboard, 64> KING_ATTACKS = makeTable(kingAttacksBB);
+constexpr std::array<std::array<Bitboard, 64>, 2> PAWN_ATTACKS = {
+    makeTable(blackPawnAttacksBB), makeTable(whitePawnAttacksBB)}; // indexed by Color
+
+struct Magic {
+    Bitboard mask;   // relevant occupancy, board edges excluded
+    Bitboard magic;
+    Bitboard *attacks;
+    unsigned shift;
+
+    unsigned index(Bitboard occupied) const
+    {
+#ifdef USE_PEXT
+        return unsigned(_pext_u64(occupied, mask));
+#else
+        return unsigned(((occupied & mask) * magic) >> shift);
+#endif
+    }
+};
+
+extern Magic BISHOP_MAGICS[64];
+extern Magic ROOK_MAGICS[64];
+extern Bitboard BETWEEN[64][64]; // squares strictly between two aligned squares
+extern Bitboard LINE[64][64];    // whole line through two aligned squares, 0 if not aligned
+
+/**
+ * @brief fill the slider attack tables, has to run before any lookup
+ * @return time spent in seconds
+ */
+double initAttacks();
+
+inline Bitboard knightAttacks(int sq) { return KNIGHT_ATTACKS[sq]; }
+inline Bitboard kingAttacks(int sq) { return KING_ATTACKS[sq]; }
+inline Bitboard pawnAttacks(int sq, bool white) { return PAWN_ATTACKS[white][sq]; }
+
+inline Bitboard bishopAttacks(int sq, Bitboard occupied)
+{
+    const Magic &m = BISHOP_MAGICS[sq];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard rookAttacks(int sq, Bitboard occupied)
+{
+    const Magic &m = ROOK_MAGICS[sq];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard queenAttacks(int sq, Bitboard occupied)
+{
+    return bishopAttacks(sq, occupied) | rookAttacks(sq, occupied);
+}
+
+inline Bitboard between(int from, int to) { return BETWEEN[from][to]; }
+inline Bitboard line(int from, int to) { return LINE[from][to]; }
+
+#endif // BITBOARD_H
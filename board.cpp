@@ -1,7 +1,33 @@
 #include "board.h"
+#include "zobrist.h"
+#include "psqt.h"
+#include "pawns.h"
 #include <sstream>
 #include <algorithm>
 #include <cassert>
+#include <cstring>
+
+/**
+ * @brief castles bits that survive a move from or to a square: moving the
+ * king or a rook, or capturing a rook, drops the matching rights
+ */
+static constexpr std::array<unsigned int, 64> makeCastleMasks()
+{
+    std::array<unsigned int, 64> masks{};
+    for (int sq = 0; sq < 64; sq++)
+        masks[sq] = 0b1111;
+    masks[0] = 0b1110;  // A8
+    masks[4] = 0b1100;  // E8
+    masks[7] = 0b1101;  // H8
+    masks[56] = 0b1011; // A1
+    masks[60] = 0b0011; // E1
+    masks[63] = 0b0111; // H1
+    return masks;
+}
+
+static constexpr std::array<unsigned int, 64> CASTLE_MASKS = makeCastleMasks();
+
+static constexpr int MAX_EVAL = TB_WIN_SCORE - MAX_PLY - 1; // network scores stay below tablebase and mate scores
 
 std::vector<std::string> Board::splitFen(const std::string &str)
 {
@@ -18,35 +44,40 @@ std::vector<std::string> Board::splitFen(const std::string &str)
 /**
  * @brief get field with X-Y-coordinates
  * standard range: x: 0=A, 7=H; y: 0=8, 7=1;
- * special values: (-1, 0): rook, (-1, 1): knight, (-1, 2): bishop, (-1, 3): queen
- * (-1, -1): out of board
  * @param x X-coordinate
  * @param y Y-coordinate
  * @return value of field, '\0' - empty field, ' ' - out of the board
  */
 char Board::getField(int x, int y)
 {
-    if (x == -1)
-    {
-        switch (y)
-        {
-        case 0:
-            return on_move ? 'R' : 'r';
-        case 1:
-            return on_move ? 'N' : 'n';
-        case 2:
-            return on_move ? 'B' : 'b';
-        case 3:
-            return on_move ? 'Q' : 'q';
-        default:
-            return ' ';
-        }
-    }
     if (std::min(x, y) < 0 || std::max(x, y) > 7)
     {
         return ' ';
     }
-    return arr[y * 8 + x];
+    int sq = y * 8 + x;
+    Piece piece = pieceOn(sq);
+    if (piece == NO_PIECE)
+        return '\0';
+    char ch = PIECE_CHARS[piece];
+    return (colors[WHITE] & squareBB(sq)) ? toupper(ch) : ch;
+}
+
+/**
+ * @brief type of the piece standing on a square
+ * @param sq square index (y*8 + x)
+ * @return piece type or NO_PIECE for an empty field
+ */
+Piece Board::pieceOn(int sq)
+{
+    return squares[sq];
+}
+
+/**
+ * @return square of a side's king, -1 if it has none
+ */
+int Board::kingSquare(bool white)
+{
+    return kings[white];
 }
 
 std::string Board::descField(Coords coords){
@@ -54,389 +85,298 @@ std::string Board::descField(Coords coords){
     return std::string("") + ((char)('A'+ x)) + std::to_string(8-y);
 }
 
-std::string Board::descSmove(const Smove *smv)
+std::string Board::descMove(Move move)
 {
-    auto [first, second] = *smv;
-    if (second.from.x == -1)
+    int from = moveFrom(move), to = moveTo(move);
+    Coords c_from = {from & 7, from >> 3};
+    Coords c_to = {to & 7, to >> 3};
+    if (isPromotion(move))
     {
-        switch (second.from.y)
-        {
-        case 0:
-            return Board::descField(first.from) + " to rook";
-        case 1:
-            return Board::descField(first.from) + " to knight";
-        case 2:
-            return Board::descField(first.from) + " to bishop";
-        case 3:
-            return Board::descField(first.from) + " to queen";
-        default:
-            return "";
-        }
+        static const char *names[4] = {"knight", "bishop", "rook", "queen"};
+        return Board::descField(c_from) + " to " + names[promotionPiece(move) - KNIGHT];
     }
-    if (second.to.x == -1)
+    switch (moveFlag(move))
     {
+    case ENPASS:
         return "enpass";
+    case CASTLE:
+        return c_to.x == 6 ? "ks castle" : "qs castle";
+    default:
+        return descField(c_from) + " -> " + descField(c_to);
     }
-    if (second.from.x == 7)
-    {
-        return "ks castle";
-    }
-    if (second.from.x == 0)
-    {
-        return "qs castle";
-    }
-    return "";
 }
 
-std::string Board::descNmove(const Nmove *mv){
-    return descField(mv->from) + " -> " + descField(mv->to);
+/**
+ * @brief long algebraic notation used by UCI and perft divide, e.g. e2e4, e7e8q
+ */
+std::string Board::descUci(Move move)
+{
+    static const char promotions[4] = {'n', 'b', 'r', 'q'};
+    int from = moveFrom(move), to = moveTo(move);
+    std::string desc = {char('a' + (from & 7)), char('8' - (from >> 3)),
+                        char('a' + (to & 7)), char('8' - (to >> 3))};
+    if (isPromotion(move))
+        desc += promotions[promotionPiece(move) - KNIGHT];
+    return desc;
 }
 
-std::string Board::descMove(const Move &move)
+/**
+ * @brief legal move of the side on move written as descUci writes it
+ * @return NO_MOVE if there is no such legal move
+ */
+Move Board::parseUci(const std::string &uci)
 {
-    if (std::holds_alternative<Nmove>(move))
+    MoveList moves;
+    allMoves(moves);
+    for (Move move : moves)
     {
-        Nmove mv = std::get<Nmove>(move);
-        return descNmove(&mv);
-    }
-    else
-    {
-        Smove smv = std::get<Smove>(move);
-        return descSmove(&smv);
+        if (descUci(move) == uci)
+            return move;
     }
+    return NO_MOVE;
 }
 
 /**
- * @brief checks if there is a collision
- * @param x X-coordinate
- * @param y Y-coordinate
- * @return 0: no collision, 1: collision, 2: opponent's piece, -1: out of board
+ * @brief place a piece on an empty square
+ * @param sq square index (y*8 + x)
+ * @param piece piece type
+ * @param white color of the piece
  */
-Collision Board::isCollision(int x, int y)
+void Board::putPiece(int sq, Piece piece, bool white)
 {
-    if (std::min(x, y) < 0 || std::max(x, y) > 7)
-        return OUT_OF_B;
-    char piece = getField(x, y);
-    if (piece == '\0')
-        return NO_COLL;
-    bool color = isupper(piece);
-    if (color == on_move)
-        return COLL;
-    else
-        return OPP;
+    Bitboard bb = squareBB(sq);
+    key ^= ZOBRIST.pieces[white][piece][sq];
+    if (piece == PAWN)
+        pawn_key ^= ZOBRIST.pieces[white][PAWN][sq];
+    score_mg += PSQT.mg[white][piece][sq];
+    score_eg += PSQT.eg[white][piece][sq];
+    phase += PHASE[piece];
+    if (NNUE.isLoaded())
+        NNUE.add(acc, sq, piece, white);
+    pieces[piece] |= bb;
+    colors[white] |= bb;
+    occupied |= bb;
+    squares[sq] = piece;
+    if (piece == KING)
+        kings[white] = sq;
 }
 
 /**
- * @brief set field
- * x: 0=A, 7=H; y: 0=8, 7=1
- * @param x X-coordinate
- * @param y Y-coordinate
- * @param piece piece to set
+ * @brief take a known piece off its square
  */
-void Board::setField(int x, int y, char piece)
+void Board::removePiece(int sq, Piece piece, bool white)
 {
-    if (std::min(x, y) < 0 || std::max(x, y) > 7)
-        return;
-    arr[y * 8 + x] = piece;
+    Bitboard bb = squareBB(sq);
+    key ^= ZOBRIST.pieces[white][piece][sq];
+    if (piece == PAWN)
+        pawn_key ^= ZOBRIST.pieces[white][PAWN][sq];
+    score_mg -= PSQT.mg[white][piece][sq];
+    score_eg -= PSQT.eg[white][piece][sq];
+    phase -= PHASE[piece];
+    if (NNUE.isLoaded())
+        NNUE.sub(acc, sq, piece, white);
+    pieces[piece] &= ~bb;
+    colors[white] &= ~bb;
+    occupied &= ~bb;
+    squares[sq] = NO_PIECE;
+    if (piece == KING)
+        kings[white] = -1;
 }
 
-bool Board::getColor(int x, int y)
+/**
+ * @brief move a known piece to an empty square; same as removePiece and
+ * putPiece, with a single network update
+ */
+void Board::shiftPiece(int from, int to, Piece piece, bool white)
 {
-    return isupper(getField(x, y));
+    Bitboard bb = squareBB(from) | squareBB(to);
+    key ^= ZOBRIST.pieces[white][piece][from] ^ ZOBRIST.pieces[white][piece][to];
+    if (piece == PAWN)
+        pawn_key ^= ZOBRIST.pieces[white][PAWN][from] ^ ZOBRIST.pieces[white][PAWN][to];
+    score_mg += PSQT.mg[white][piece][to] - PSQT.mg[white][piece][from];
+    score_eg += PSQT.eg[white][piece][to] - PSQT.eg[white][piece][from];
+    if (NNUE.isLoaded())
+        NNUE.move(acc, from, to, piece, white);
+    pieces[piece] ^= bb;
+    colors[white] ^= bb;
+    occupied ^= bb;
+    squares[from] = NO_PIECE;
+    squares[to] = piece;
+    if (piece == KING)
+        kings[white] = to;
 }
 
-std::vector<Nmove> Board::pMoves(Coords from)
+void Board::switchSide()
 {
-    std::vector<Nmove> moves;
-    auto [x, y] = from;
-    int dir = on_move ? -1 : 1;
-    int start = on_move ? 6 : 1;
-    int end = 7 - start;
-    if (y != end && isCollision(x, y + dir) == NO_COLL)
-        moves.push_back({from, {x, y + dir}});
-    if (isCollision(x + 1, y + dir) == OPP)
-        moves.push_back({from, {x + 1, y + dir}});
-    if (isCollision(x - 1, y + dir) == OPP)
-        moves.push_back({from, {x - 1, y + dir}});
-    if (y == start && isCollision(x, y + 2 * dir) == NO_COLL)
-        moves.push_back({from, {x, y + 2 * dir}});
-
-    return moves;
+    on_move = !on_move;
+    key ^= ZOBRIST.side;
 }
-std::vector<Nmove> Board::nMoves(Coords from)
-{
-    std::vector<Nmove> moves;
-    auto [x, y] = from;
-    const std::vector<Coords> knight_moves = {
-        {1, 2}, {1, -2}, {-1, 2}, {-1, -2}, {2, 1}, {2, -1}, {-2, 1}, {-2, -1}};
-
-    for (const auto &move : knight_moves)
-    {
-        int x1 = x + move.x;
-        int y1 = y + move.y;
-        char coll = isCollision(x1, y1);
-        if (coll == OUT_OF_B || coll == COLL)
-            continue;
-
-        moves.push_back({from, {x1, y1}});
-    }
 
-    return moves;
-}
-std::vector<Nmove> Board::bMoves(Coords from)
+/**
+ * @brief bring the key up to date after castles and enpass changed
+ * @param old_castles castles before the change
+ * @param old_enpass enpass before the change
+ */
+void Board::updateStateKey(unsigned int old_castles, int old_enpass)
 {
-    std::vector<Nmove> moves;
-    auto [x, y] = from;
-
-    int x1 = x + 1, y1 = y + 1;
-    while (isCollision(x1, y1) == NO_COLL)
+    unsigned int changed = castles ^ old_castles;
+    for (int i = 0; i < 4; i++)
     {
-        moves.push_back({from, {x1, y1}});
-        x1++;
-        y1++;
+        if (changed & (1 << i))
+            key ^= ZOBRIST.castles[i];
     }
-    if (isCollision(x1, y1) == OPP)
-        moves.push_back({from, {x1, y1}});
-
-    x1 = x - 1, y1 = y - 1;
-    while (isCollision(x1, y1) == NO_COLL)
+    if (old_enpass != enpass)
     {
-        moves.push_back({from, {x1, y1}});
-        x1--;
-        y1--;
+        if (old_enpass != -1)
+            key ^= ZOBRIST.enpass[old_enpass & 7];
+        if (enpass != -1)
+            key ^= ZOBRIST.enpass[enpass & 7];
     }
-    if (isCollision(x1, y1) == OPP)
-        moves.push_back({from, {x1, y1}});
+}
 
-    x1 = x + 1, y1 = y - 1;
-    while (isCollision(x1, y1) == NO_COLL)
+/**
+ * @brief key of the position computed from scratch
+ */
+uint64_t Board::computeKey()
+{
+    uint64_t full = on_move ? ZOBRIST.side : 0;
+    for (int c = BLACK; c <= WHITE; c++)
     {
-        moves.push_back({from, {x1, y1}});
-        x1++;
-        y1--;
+        for (int p = PAWN; p <= KING; p++)
+        {
+            Bitboard set = pieces[p] & colors[c];
+            while (set)
+                full ^= ZOBRIST.pieces[c][p][popLsb(set)];
+        }
     }
-    if (isCollision(x1, y1) == OPP)
-        moves.push_back({from, {x1, y1}});
-
-    x1 = x - 1, y1 = y + 1;
-    while (isCollision(x1, y1) == NO_COLL)
+    for (int i = 0; i < 4; i++)
     {
-        moves.push_back({from, {x1, y1}});
-        x1--;
-        y1++;
+        if (castles & (1 << i))
+            full ^= ZOBRIST.castles[i];
     }
-    if (isCollision(x1, y1) == OPP)
-        moves.push_back({from, {x1, y1}});
-
-    return moves;
+    if (enpass != -1)
+        full ^= ZOBRIST.enpass[enpass & 7];
+    return full;
 }
-std::vector<Nmove> Board::rMoves(Coords from)
-{
-    std::vector<Nmove> moves;
-    auto [x, y] = from;
 
-    int x1 = x, y1 = y + 1;
-    while (isCollision(x1, y1) == NO_COLL)
-    {
-        moves.push_back({from, {x1, y1}});
-        y1++;
-    }
-    if (isCollision(x1, y1) == OPP)
-        moves.push_back({from, {x1, y1}});
+/**
+ * @brief append a move from one field to every square of a target set
+ */
+void Board::addMoves(MoveList &moves, int from, Bitboard targets)
+{
+    while (targets)
+        moves.add(makeMove(from, popLsb(targets)));
+}
 
-    x1 = x, y1 = y - 1;
-    while (isCollision(x1, y1) == NO_COLL)
-    {
-        moves.push_back({from, {x1, y1}});
-        y1--;
-    }
-    if (isCollision(x1, y1) == OPP)
-        moves.push_back({from, {x1, y1}});
+/**
+ * @param allowed target squares that keep the own king safe: the check mask,
+ * narrowed to the pin line for a pinned pawn
+ */
+void Board::pMoves(MoveList &moves, int from, Bitboard allowed)
+{
+    Bitboard bb = squareBB(from);
+    Direction dir = on_move ? NORTH : SOUTH;
+    int start = on_move ? 6 : 1;
 
-    x1 = x + 1, y1 = y;
-    while (isCollision(x1, y1) == NO_COLL)
-    {
-        moves.push_back({from, {x1, y1}});
-        x1++;
-    }
-    if (isCollision(x1, y1) == OPP)
-        moves.push_back({from, {x1, y1}});
+    Bitboard targets = pawnAttacks(from, on_move) & colors[!on_move];
+    Bitboard push = shift(bb, dir) & ~occupied;
+    targets |= push;
+    if ((from >> 3) == start)
+        targets |= shift(push, dir) & ~occupied;
+    targets &= allowed;
 
-    x1 = x - 1, y1 = y;
-    while (isCollision(x1, y1) == NO_COLL)
+    Bitboard last_rank = on_move ? RANK_8 : RANK_1;
+    if (targets & last_rank)
     {
-        moves.push_back({from, {x1, y1}});
-        x1--;
+        while (targets)
+        {
+            int to = popLsb(targets);
+            for (Piece piece : {QUEEN, ROOK, BISHOP, KNIGHT})
+                moves.add(makePromotion(from, to, piece));
+        }
+        return;
     }
-    if (isCollision(x1, y1) == OPP)
-        moves.push_back({from, {x1, y1}});
-
-    return moves;
+    addMoves(moves, from, targets);
 }
-std::vector<Nmove> Board::qMoves(Coords from)
+void Board::nMoves(MoveList &moves, int from, Bitboard allowed)
 {
-    std::vector<Nmove> moves = bMoves(from);
-    std::vector<Nmove> new_moves = rMoves(from);
-    moves.insert(moves.end(), new_moves.begin(), new_moves.end());
-    return moves;
+    addMoves(moves, from, knightAttacks(from) & ~colors[on_move] & allowed);
 }
-std::vector<Nmove> Board::kMoves(Coords from)
+void Board::bMoves(MoveList &moves, int from, Bitboard allowed)
 {
-    std::vector<Nmove> moves;
-    auto [x, y] = from;
-
-    if (isCollision(x + 1, y + 1) == NO_COLL || isCollision(x + 1, y + 1) == OPP)
-        moves.push_back({from, {x + 1, y + 1}});
-    if (isCollision(x, y + 1) == NO_COLL || isCollision(x, y + 1) == OPP)
-        moves.push_back({from, {x, y + 1}});
-    if (isCollision(x - 1, y + 1) == NO_COLL || isCollision(x - 1, y + 1) == OPP)
-        moves.push_back({from, {x - 1, y + 1}});
-
-    if (isCollision(x + 1, y) == NO_COLL || isCollision(x + 1, y) == OPP)
-        moves.push_back({from, {x + 1, y}});
-    if (isCollision(x - 1, y) == NO_COLL || isCollision(x - 1, y) == OPP)
-        moves.push_back({from, {x - 1, y}});
-
-    if (isCollision(x + 1, y - 1) == NO_COLL || isCollision(x + 1, y - 1) == OPP)
-        moves.push_back({from, {x + 1, y - 1}});
-    if (isCollision(x, y - 1) == NO_COLL || isCollision(x, y - 1) == OPP)
-        moves.push_back({from, {x, y - 1}});
-    if (isCollision(x - 1, y - 1) == NO_COLL || isCollision(x - 1, y - 1) == OPP)
-        moves.push_back({from, {x - 1, y - 1}});
-
-    return moves;
+    addMoves(moves, from, bishopAttacks(from, occupied) & ~colors[on_move] & allowed);
 }
-
-bool Board::nChecking(Coords from)
+void Board::rMoves(MoveList &moves, int from, Bitboard allowed)
 {
-    auto [x, y] = from;
-    const std::vector<Coords> knight_moves = {
-        {1, 2}, {1, -2}, {-1, 2}, {-1, -2}, {2, 1}, {2, -1}, {-2, 1}, {-2, -1}};
-
-    for (const auto &move : knight_moves)
-    {
-        int x1 = x + move.x;
-        int y1 = y + move.y;
-
-        if (isCollision(x1, y1) == OPP && tolower(getField(x1, y1)) == 'n')
-            return true;
-    }
-    return false;
+    addMoves(moves, from, rookAttacks(from, occupied) & ~colors[on_move] & allowed);
 }
-bool Board::bChecking(Coords from, char piece)
+void Board::qMoves(MoveList &moves, int from, Bitboard allowed)
 {
-    auto [x, y] = from;
-
-    int x1 = x + 1, y1 = y + 1;
-    while (isCollision(x1, y1) == NO_COLL)
-    {
-        x1++;
-        y1++;
-    }
-    if (isCollision(x1, y1) == OPP && tolower(getField(x1, y1)) == piece)
-        return true;
-
-    x1 = x - 1, y1 = y - 1;
-    while (isCollision(x1, y1) == NO_COLL)
-    {
-        x1--;
-        y1--;
-    }
-    if (isCollision(x1, y1) == OPP && tolower(getField(x1, y1)) == piece)
-        return true;
-
-    x1 = x + 1, y1 = y - 1;
-    while (isCollision(x1, y1) == NO_COLL)
-    {
-        x1++;
-        y1--;
-    }
-    if (isCollision(x1, y1) == OPP && tolower(getField(x1, y1)) == piece)
-        return true;
-
-    x1 = x - 1, y1 = y + 1;
-    while (isCollision(x1, y1) == NO_COLL)
-    {
-        x1--;
-        y1++;
-    }
-    if (isCollision(x1, y1) == OPP && tolower(getField(x1, y1)) == piece)
-        return true;
-
-    return false;
+    addMoves(moves, from, queenAttacks(from, occupied) & ~colors[on_move] & allowed);
 }
-bool Board::rChecking(Coords from, char piece)
+/**
+ * @brief king steps to squares the opponent does not attack; sliders are
+ * looked up without the king so it cannot step back along a checking ray
+ */
+void Board::kMoves(MoveList &moves, int from, Bitboard allowed)
 {
-    auto [x, y] = from;
-
-    int x1 = x, y1 = y + 1;
-    while (isCollision(x1, y1) == NO_COLL)
-    {
-        y1++;
-    }
-    if (isCollision(x1, y1) == OPP && tolower(getField(x1, y1)) == piece)
-        return true;
-
-    x1 = x, y1 = y - 1;
-    while (isCollision(x1, y1) == NO_COLL)
-    {
-        y1--;
-    }
-    if (isCollision(x1, y1) == OPP && tolower(getField(x1, y1)) == piece)
-        return true;
-
-    x1 = x + 1, y1 = y;
-    while (isCollision(x1, y1) == NO_COLL)
+    Bitboard targets = kingAttacks(from) & ~colors[on_move] & allowed;
+    Bitboard occ = occupied ^ squareBB(from);
+    while (targets)
     {
-        x1++;
+        int to = popLsb(targets);
+        if (!(attackersTo(to, occ) & colors[!on_move]))
+            moves.add(makeMove(from, to));
     }
-    if (isCollision(x1, y1) == OPP && tolower(getField(x1, y1)) == piece)
-        return true;
-
-    x1 = x - 1, y1 = y;
-    while (isCollision(x1, y1) == NO_COLL)
-    {
-        x1--;
-    }
-    if (isCollision(x1, y1) == OPP && tolower(getField(x1, y1)) == piece)
-        return true;
-
-    return false;
 }
-bool Board::qChecking(Coords from)
+
+/**
+ * @brief pieces of both colors attacking a square
+ * @param occ occupancy used to block sliders
+ */
+Bitboard Board::attackersTo(int sq, Bitboard occ)
 {
-    return bChecking(from, 'q') || rChecking(from, 'q');
+    return (pawnAttacks(sq, true) & pieces[PAWN] & colors[BLACK]) |
+           (pawnAttacks(sq, false) & pieces[PAWN] & colors[WHITE]) |
+           (knightAttacks(sq) & pieces[KNIGHT]) |
+           (kingAttacks(sq) & pieces[KING]) |
+           (bishopAttacks(sq, occ) & (pieces[BISHOP] | pieces[QUEEN])) |
+           (rookAttacks(sq, occ) & (pieces[ROOK] | pieces[QUEEN]));
 }
-bool Board::pChecking(Coords from)
+
+/**
+ * @brief checks if the opponent of the side on move attacks a square
+ */
+bool Board::isAttacked(int sq)
 {
-    auto [x, y] = from;
-    int dir = on_move ? -1 : 1;
-    if (isCollision(x + 1, y + dir) == OPP && tolower(getField(x + 1, y + dir)) == 'p')
-        return true;
-    if (isCollision(x - 1, y + dir) == OPP && tolower(getField(x - 1, y + dir)) == 'p')
-        return true;
-    return false;
+    return attackersTo(sq, occupied) & colors[!on_move];
 }
 
-Coords Board::getKingOnMove()
+/**
+ * @brief own pieces that are the only blocker between the king and an
+ * enemy slider
+ */
+Bitboard Board::pinnedPieces(int king)
 {
-    int x = -1, y = -1;
-    for (size_t i = 0; i < 8; i++)
+    Bitboard enemy = colors[!on_move];
+    Bitboard snipers = ((rookAttacks(king, 0) & (pieces[ROOK] | pieces[QUEEN])) |
+                        (bishopAttacks(king, 0) & (pieces[BISHOP] | pieces[QUEEN]))) & enemy;
+    Bitboard pinned = 0;
+    while (snipers)
     {
-        for (size_t j = 0; j < 8; j++)
-        {
-            if (tolower(getField(i, j)) == 'k' && getColor(i, j) == on_move)
-            {
-                x = i;
-                y = j;
-                break;
-            }
-        }
-        if (x != -1 && y != -1)
-            break;
+        Bitboard blockers = between(king, popLsb(snipers)) & occupied;
+        if (blockers && !(blockers & (blockers - 1)))
+            pinned |= blockers & colors[on_move];
     }
+    return pinned;
+}
 
-    return {x, y};
+/**
+ * @return square of the king on move, -1 if there is none
+ */
+int Board::getKingOnMove()
+{
+    return kings[on_move];
 }
 
 Board::Board(std::string fen)
@@ -445,19 +385,44 @@ Board::Board(std::string fen)
     {
         fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -";
     }
+    undo_stack.reserve(MAX_PLY);
     readFen(fen);
 }
 
 Board::Board(const Board &other)
 {
-    for (size_t i = 0; i < 64; i++)
+    undo_stack.reserve(MAX_PLY);
+    *this = other;
+}
+
+/**
+ * @brief copy the position only, the undo history stays with the source
+ */
+Board &Board::operator=(const Board &other)
+{
+    undo_stack.clear();
+    for (size_t i = 0; i < 6; i++)
     {
-        arr[i] = other.arr[i];
+        pieces[i] = other.pieces[i];
     }
+    colors[WHITE] = other.colors[WHITE];
+    colors[BLACK] = other.colors[BLACK];
+    occupied = other.occupied;
+    std::copy(std::begin(other.squares), std::end(other.squares), squares);
+    kings[WHITE] = other.kings[WHITE];
+    kings[BLACK] = other.kings[BLACK];
     castles = other.castles;
     enpass = other.enpass;
+    key = other.key;
+    pawn_key = other.pawn_key;
+    score_mg = other.score_mg;
+    score_eg = other.score_eg;
+    phase = other.phase;
+    if (NNUE.isLoaded())
+        acc = other.acc;
 
     on_move = other.on_move;
+    return *this;
 }
 
 std::ostream &operator<<(std::ostream &os, Board &bd)
@@ -489,7 +454,7 @@ std::ostream &operator<<(std::ostream &os, Board &bd)
 
     castles_val = castles_val != "" ? castles_val : "-";
     os << "castles: " << castles_val << "\n";
-    std::string enpass_val = bd.enpass.x == -1 ? "-" : Board::descField(bd.enpass);
+    std::string enpass_val = bd.enpass == -1 ? "-" : Board::descField({bd.enpass & 7, bd.enpass >> 3});
     os << "enpass: " << enpass_val << "\n";
     os << "score: " << bd.getScore() << "\n";
     return os;
@@ -497,12 +462,19 @@ std::ostream &operator<<(std::ostream &os, Board &bd)
 
 void Board::readFen(std::string fen)
 {
-    for (int i = 0; i < 64; i++)
-    {
-        arr[i] = '\0';
-    }
+    for (Bitboard &set : pieces)
+        set = 0;
+    colors[WHITE] = colors[BLACK] = 0;
+    occupied = 0;
+    std::fill(std::begin(squares), std::end(squares), NO_PIECE);
+    kings[WHITE] = kings[BLACK] = -1;
+    key = pawn_key = 0;
+    score_mg = score_eg = phase = 0;
+    if (NNUE.isLoaded())
+        NNUE.reset(acc);
     castles = 0;
-    enpass = {-1, -1};
+    enpass = -1;
+    undo_stack.clear();
 
     int pos = 0;
 
@@ -519,18 +491,33 @@ void Board::readFen(std::string fen)
 
     on_move = fen_mv[0] == 'w';
 
+    // eight ranks of eight squares each, one king per side
+    int file = 0;
     for (const char &piece : fen_bd)
     {
-        if (isdigit(piece))
-            pos += atoi(&piece);
-        else
+        if (piece == '/')
+        {
+            if (file != 8 || pos == 64)
+                throw std::runtime_error("Invalid fen!");
+            file = 0;
+            continue;
+        }
+        int squares = isdigit(piece) ? piece - '0' : 1;
+        if (squares < 1 || file + squares > 8)
+            throw std::runtime_error("Invalid fen!");
+        if (!isdigit(piece))
         {
-            if (piece == '/')
-                continue;
-            arr[pos] = piece;
-            pos++;
+            const char *type = std::strchr(PIECE_CHARS, tolower(piece));
+            if (type == nullptr || *type == '\0')
+                throw std::runtime_error("Invalid fen!");
+            putPiece(pos, Piece(type - PIECE_CHARS), isupper(piece));
         }
+        pos += squares;
+        file += squares;
     }
+    if (pos != 64 || file != 8 || popCount(pieces[KING] & colors[WHITE]) != 1 ||
+        popCount(pieces[KING] & colors[BLACK]) != 1)
+        throw std::runtime_error("Invalid fen!");
 
     if (count(fen_cs.begin(), fen_cs.end(), 'K') == 1)
         castles = castles | 0b1000;
@@ -541,12 +528,16 @@ void Board::readFen(std::string fen)
     if (count(fen_cs.begin(), fen_cs.end(), 'q') == 1)
         castles = castles | 0b0001;
 
-    if (fen_en.length() == 2)
+    // '-' or the square behind a pawn the other side just pushed two squares
+    if (fen_en != "-")
     {
+        if (fen_en.length() != 2 || fen_en[0] < 'a' || fen_en[0] > 'h' || fen_en[1] != (on_move ? '6' : '3'))
+            throw std::runtime_error("Invalid fen!");
         int x = (int)fen_en[0] - (int)'a';
-        int y = atoi(&fen_en[1]);
-        enpass = {x, y};
+        int y = 8 - (fen_en[1] - '0');
+        enpass = y * 8 + x;
     }
+    key = computeKey();
     return;
 }
 
@@ -555,316 +546,632 @@ bool Board::onMove()
     return on_move;
 }
 
-std::vector<Nmove> Board::getMoves(Coords from)
+uint64_t Board::getKey()
 {
-    auto [x, y] = from;
-    char piece = getField(x, y);
-
-    if (piece == '\0' || getColor(x, y) != on_move)
-        return {};
-
-    piece = tolower(piece);
-    switch (piece)
-    {
-    case 'p':
-        return pMoves(from);
-    case 'n':
-        return nMoves(from);
-    case 'b':
-        return bMoves(from);
-    case 'r':
-        return rMoves(from);
-    case 'q':
-        return qMoves(from);
-    case 'k':
-        return kMoves(from);
-    default:
-        return {};
-    }
+    return key;
 }
 
-std::vector<Nmove> Board::normalMoves()
+uint64_t Board::pawnKey()
 {
-    std::vector<Nmove> moves;
-    for (int i = 0; i < 8; i++)
+    return pawn_key;
+}
+
+/**
+ * @brief key of the position in Polyglot opening books
+ * @param random the 781 Random64 values of the Polyglot format: 768 for
+ * pieces, 4 for castling rights, 8 for en passant files, 1 for white on move
+ * @note Polyglot counts the en passant file only if a pawn on move can
+ * actually capture there; its squares run from a1 and its pieces alternate
+ * black and white of each kind
+ */
+uint64_t Board::polyglotKey(const uint64_t *random)
+{
+    uint64_t full = 0;
+    for (int c = BLACK; c <= WHITE; c++)
     {
-        for (int j = 0; j < 8; j++)
+        for (int p = PAWN; p <= KING; p++)
         {
-            if (getColor(i, j) != on_move)
-                continue;
-            std::vector<Nmove> new_moves = getMoves({i, j});
-            moves.insert(moves.end(), new_moves.begin(), new_moves.end());
+            Bitboard set = pieces[p] & colors[c];
+            while (set)
+                full ^= random[64 * (2 * p + c) + (popLsb(set) ^ 56)];
         }
     }
-    return moves;
+    static constexpr unsigned int CASTLE_BITS[4] = {0b1000, 0b0100, 0b0010, 0b0001};
+    for (int i = 0; i < 4; i++)
+    {
+        if (castles & CASTLE_BITS[i])
+            full ^= random[768 + i];
+    }
+    if (enpass != -1 && (pawnAttacks(enpass, !on_move) & pieces[PAWN] & colors[on_move]))
+        full ^= random[772 + (enpass & 7)];
+    if (on_move)
+        full ^= random[780];
+    return full;
 }
 
-std::vector<Smove> Board::specialMoves()
+/**
+ * @brief legal moves of the piece standing on a field
+ */
+void Board::getMoves(MoveList &moves, Coords from)
 {
-    std::vector<std::pair<Nmove, Nmove>> moves;
+    auto [x, y] = from;
+    if (std::min(x, y) < 0 || std::max(x, y) > 7)
+        return;
+    int sq = y * 8 + x;
 
-    // check if pawns can transform
-    int dir = on_move ? -1 : 1;
-    int end = on_move ? 1 : 6;
-    char pawn_pattern = on_move ? 'P' : 'p';
-    for (int x = 0; x < 8; x++)
+    MoveList all;
+    allMoves(all);
+    for (Move move : all)
     {
-        if (getField(x, end) == pawn_pattern)
-        {
-            for (int i = 0; i < 4; i++)
-            {
-                moves.push_back({{{x, end}, {x, end + dir}}, {{-1, i}, {x, end + dir}}});
-            }
-        }
+        if (moveFrom(move) == sq)
+            moves.add(move);
     }
+}
 
-    // check for enpassant
-    auto [x, y] = enpass;
-    int pass_line = on_move ? 3 : 4;
-    if (x >= 0 && y >= 0)
+/**
+ * @brief moves of every piece but the king
+ * @param allowed target mask of the node (all squares, or the check mask)
+ * @param pinned pinned own pieces, they stay on the line to their king
+ * @param pawn_allowed further limits the pawn targets (quiet moves leave out promotions)
+ */
+void Board::normalMoves(MoveList &moves, int king, Bitboard allowed, Bitboard pinned, Bitboard pawn_allowed)
+{
+    Bitboard own = colors[on_move];
+    auto mask = [&](int from) {
+        return (pinned & squareBB(from)) ? allowed & line(king, from) : allowed;
+    };
+    for (Bitboard set = pieces[PAWN] & own; set;)
     {
-        char field;
-        for(int i = -1; i <= 1; i += 2){
-            field = getField(x + i, pass_line);
-            if (field != '\0' && field != ' ')
-                moves.push_back({{{x + i, pass_line}, enpass}, {{x, pass_line}, {-1, -1}}});
-        }
+        int from = popLsb(set);
+        pMoves(moves, from, mask(from) & pawn_allowed);
     }
+    // a pinned knight can never move
+    for (Bitboard set = pieces[KNIGHT] & own & ~pinned; set;)
+        nMoves(moves, popLsb(set), allowed);
+    for (Bitboard set = pieces[BISHOP] & own; set;)
+    {
+        int from = popLsb(set);
+        bMoves(moves, from, mask(from));
+    }
+    for (Bitboard set = pieces[ROOK] & own; set;)
+    {
+        int from = popLsb(set);
+        rMoves(moves, from, mask(from));
+    }
+    for (Bitboard set = pieces[QUEEN] & own; set;)
+    {
+        int from = popLsb(set);
+        qMoves(moves, from, mask(from));
+    }
+}
+
+/**
+ * @brief en passant captures, played on the occupancy to look for a
+ * discovered attack on the king
+ */
+void Board::enpassMoves(MoveList &moves, int king)
+{
+    if (enpass == -1)
+        return;
+    int captured = on_move ? enpass + 8 : enpass - 8;
+    Bitboard pawns = pawnAttacks(enpass, !on_move) & pieces[PAWN] & colors[on_move];
+    while (pawns)
+    {
+        int from = popLsb(pawns);
+        Bitboard occ = (occupied ^ squareBB(from) ^ squareBB(captured)) | squareBB(enpass);
+        if (!(attackersTo(king, occ) & colors[!on_move] & ~squareBB(captured)))
+            moves.add(makeMove(from, enpass, ENPASS));
+    }
+}
 
-    // check for castling
-    int king_line = on_move ? 7 : 0;
+/**
+ * @brief castling; the king must not be in check
+ */
+void Board::castleMoves(MoveList &moves, int king)
+{
+    int home = on_move ? 60 : 4;
+    if (king != home)
+        return;
+    Bitboard rooks = pieces[ROOK] & colors[on_move];
 
-    if (castles & (0b10 << (on_move ? 2 : 0)))
+    if ((castles & (0b10 << (on_move ? 2 : 0))) && (rooks & squareBB(king + 3)))
     {
-        if (getField(5, king_line) == '\0' && getField(6, king_line) == '\0' &&
-            (!isCheck({4, king_line}) && !isCheck({5, king_line}) && !isCheck({6, king_line})))
+        if (!(occupied & (squareBB(king + 1) | squareBB(king + 2))) &&
+            !isAttacked(king + 1) && !isAttacked(king + 2))
         {
-
-            moves.push_back({{{4, king_line}, {6, king_line}}, {{7, king_line}, {5, king_line}}});
+            moves.add(makeMove(king, king + 2, CASTLE));
         }
     }
 
-    if (castles & (0b01 << (on_move ? 2 : 0)))
+    if ((castles & (0b01 << (on_move ? 2 : 0))) && (rooks & squareBB(king - 4)))
     {
-        if (getField(1, king_line) == '\0' && getField(2, king_line) == '\0' && getField(3, king_line) == '\0' &&
-            (!isCheck({1, king_line}) && !isCheck({2, king_line}) && !isCheck({3, king_line}) && !isCheck({4, king_line})))
+        if (!(occupied & (squareBB(king - 1) | squareBB(king - 2) | squareBB(king - 3))) &&
+            !isAttacked(king - 1) && !isAttacked(king - 2))
         {
-            moves.push_back({{{4, king_line}, {2, king_line}}, {{0, king_line}, {3, king_line}}});
+            moves.add(makeMove(king, king - 2, CASTLE));
         }
     }
+}
 
-    return moves;
+/**
+ * @brief en passant and castling
+ * @param checkers enemy pieces giving check
+ */
+void Board::specialMoves(MoveList &moves, int king, Bitboard checkers)
+{
+    enpassMoves(moves, king);
+    if (!checkers)
+        castleMoves(moves, king);
 }
 
-std::vector<Move> Board::allMoves(){
-    std::vector<Nmove> nmoves = Board::normalMoves();
-    std::vector<Smove> smoves = Board::specialMoves();
+/**
+ * @brief moves out of check: the king steps away, and against a single
+ * checker another piece may capture it or block the ray
+ */
+void Board::evasionMoves(MoveList &moves, int king, Bitboard checkers, Bitboard pinned)
+{
+    kMoves(moves, king, ~Bitboard(0));
+    if (checkers & (checkers - 1))
+        return;
+    int checker = lsb(checkers);
+    normalMoves(moves, king, between(king, checker) | checkers, pinned);
+    specialMoves(moves, king, checkers);
+}
 
-    std::vector<Move> moves;
-    moves.reserve(1 + nmoves.size() + smoves.size());
-    moves.insert(moves.end(), nmoves.begin(), nmoves.end());
-    moves.insert(moves.end(), smoves.begin(), smoves.end());
+/**
+ * @brief legal moves of the side on move; checkers and pins are found once
+ * so no move has to be tried and taken back
+ */
+void Board::allMoves(MoveList &moves)
+{
+    int king = getKingOnMove();
+    if (king == -1)
+        return;
+    Bitboard checkers = attackersTo(king, occupied) & colors[!on_move];
+    Bitboard pinned = pinnedPieces(king);
 
-    return moves;
+    if (checkers)
+    {
+        evasionMoves(moves, king, checkers, pinned);
+        return;
+    }
+    normalMoves(moves, king, ~colors[on_move], pinned);
+    kMoves(moves, king, ~Bitboard(0));
+    specialMoves(moves, king, checkers);
 }
 
-bool Board::isCheck(Coords from)
+/**
+ * @brief legal captures and promotions of the side on move, the moves of
+ * the quiescence search; in check all evasions are generated instead
+ */
+void Board::captureMoves(MoveList &moves)
 {
-    if (from.x == -1)
+    int king = getKingOnMove();
+    if (king == -1)
+        return;
+    Bitboard checkers = attackersTo(king, occupied) & colors[!on_move];
+    Bitboard pinned = pinnedPieces(king);
+
+    if (checkers)
     {
-        from = getKingOnMove();
+        evasionMoves(moves, king, checkers, pinned);
+        return;
+    }
+    Bitboard enemy = colors[!on_move];
+    normalMoves(moves, king, enemy, pinned);
+    kMoves(moves, king, enemy);
+    enpassMoves(moves, king);
+
+    // promotions by a push, captures with promotion came with normalMoves
+    Bitboard last_rank = on_move ? RANK_8 : RANK_1;
+    Bitboard promoting = pieces[PAWN] & colors[on_move] & shift(last_rank, on_move ? SOUTH : NORTH);
+    while (promoting)
+    {
+        int from = popLsb(promoting);
+        Bitboard allowed = last_rank & ~occupied;
+        if (pinned & squareBB(from))
+            allowed &= line(king, from);
+        pMoves(moves, from, allowed);
     }
-    return bChecking(from) || rChecking(from) || nChecking(from) || pChecking(from) || qChecking(from);
 }
 
-bool Board::isMate()
+/**
+ * @brief legal moves that neither capture nor promote, castling included:
+ * together with captureMoves every legal move. In check there are none,
+ * captureMoves gave all evasions.
+ */
+void Board::quietMoves(MoveList &moves)
 {
-    if (!isCheck())
+    int king = getKingOnMove();
+    if (king == -1)
+        return;
+    if (attackersTo(king, occupied) & colors[!on_move])
+        return;
+    Bitboard pinned = pinnedPieces(king);
+
+    Bitboard empty = ~occupied;
+    normalMoves(moves, king, empty, pinned, ~(on_move ? RANK_8 : RANK_1));
+    kMoves(moves, king, empty);
+    castleMoves(moves, king);
+}
+
+/**
+ * @brief whether a move, say from the hash table or a killer slot, is
+ * legal in this position; only the moves of its piece are generated
+ */
+bool Board::isLegal(Move move)
+{
+    int from = moveFrom(move);
+    int king = getKingOnMove();
+    if (move == NO_MOVE || king == -1 || !(colors[on_move] & squareBB(from)))
         return false;
-    std::vector<Nmove> moves = normalMoves();
-    bool found = false;
-    for (const auto &move : moves)
+    Bitboard checkers = attackersTo(king, occupied) & colors[!on_move];
+
+    MoveList moves;
+    Piece piece = pieceOn(from);
+    if (moveFlag(move) == ENPASS)
+        enpassMoves(moves, king);
+    else if (moveFlag(move) == CASTLE)
+    {
+        if (!checkers)
+            castleMoves(moves, king);
+    }
+    else if (piece == KING)
+        kMoves(moves, king, ~Bitboard(0));
+    else if (!(checkers & (checkers - 1))) // in double check only the king moves
     {
-        found = movePiece(move);
-        if (found)
+        Bitboard allowed = checkers ? between(king, lsb(checkers)) | checkers : ~colors[on_move];
+        if (pinnedPieces(king) & squareBB(from))
+            allowed &= line(king, from);
+        switch (piece)
         {
-            assert(undoMove());
-            return false;
+        case PAWN:
+            pMoves(moves, from, allowed);
+            break;
+        case KNIGHT:
+            nMoves(moves, from, allowed);
+            break;
+        case BISHOP:
+            bMoves(moves, from, allowed);
+            break;
+        case ROOK:
+            rMoves(moves, from, allowed);
+            break;
+        default:
+            qMoves(moves, from, allowed);
+            break;
         }
     }
-    return true;
+    return std::find(moves.begin(), moves.end(), move) != moves.end();
+}
+
+/**
+ * @brief static exchange evaluation: material won by the side on move when
+ * both sides keep recapturing on the target square with their least
+ * valuable attacker and may stop whenever that is better; pins are ignored
+ * @return gain in centipawns, negative for a losing capture
+ */
+int Board::see(Move move)
+{
+    int from = moveFrom(move), to = moveTo(move);
+    if (moveFlag(move) == CASTLE)
+        return 0;
+
+    int gain[32];
+    int d = 0;
+    Bitboard occ = occupied ^ squareBB(from);
+    Piece on_square = pieceOn(from); // piece the next capture would take
+    Piece victim = pieceOn(to);
+    if (moveFlag(move) == ENPASS)
+    {
+        victim = PAWN;
+        occ ^= squareBB(on_move ? to + 8 : to - 8);
+    }
+    gain[0] = victim == NO_PIECE ? 0 : PIECE_VALUES[victim];
+    if (isPromotion(move))
+    {
+        on_square = promotionPiece(move);
+        gain[0] += PIECE_VALUES[on_square] - PIECE_VALUES[PAWN];
+    }
+
+    Bitboard diagonal = pieces[BISHOP] | pieces[QUEEN];
+    Bitboard straight = pieces[ROOK] | pieces[QUEEN];
+    Bitboard attackers = attackersTo(to, occ) & occ;
+    bool side = !on_move;
+    while (d < 31)
+    {
+        Bitboard own = attackers & colors[side];
+        if (!own)
+            break;
+        int piece = PAWN;
+        while (!(own & pieces[piece]))
+            piece++;
+        // the king may only take the last defender
+        if (piece == KING && (attackers & colors[!side]))
+            break;
+
+        d++;
+        gain[d] = PIECE_VALUES[on_square] - gain[d - 1];
+        on_square = Piece(piece);
+        occ ^= squareBB(lsb(own & pieces[piece]));
+        // sliders behind the one that captured join in
+        attackers |= (bishopAttacks(to, occ) & diagonal) | (rookAttacks(to, occ) & straight);
+        attackers &= occ;
+        side = !side;
+    }
+    while (d > 0)
+    {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+        d--;
+    }
+    return gain[0];
+}
+
+bool Board::isCheck()
+{
+    int king = getKingOnMove();
+    if (king == -1)
+        return false;
+    return isAttacked(king);
+}
+
+bool Board::isMate()
+{
+    if (!isCheck())
+        return false;
+    MoveList moves;
+    allMoves(moves);
+    return moves.empty();
 }
 
 bool Board::isStaleMate()
 {
     if (isCheck())
         return false;
+    MoveList moves;
+    allMoves(moves);
+    return moves.empty();
+}
 
-    std::vector<Nmove> moves = normalMoves();
-    bool found = false;
-    for (const auto &move : moves)
+/**
+ * @brief finish a move whose pieces are already placed: update the key,
+ * pass the turn and remember how to take the move back
+ */
+void Board::pushMove(const UndoMove &undo_move)
+{
+    updateStateKey(undo_move.castles, undo_move.enpass);
+#ifdef DEBUG
+    assert(!isCheck());
+#endif
+    switchSide();
+    undo_stack.push_back(undo_move);
+#ifdef DEBUG
+    assert(key == computeKey());
+#endif
+}
+
+void Board::nmovePiece(Move move)
+{
+    int from = moveFrom(move), to = moveTo(move);
+    UndoMove undo_move = {move, NO_PIECE, castles, enpass};
+
+    Piece piece = pieceOn(from);
+    if (occupied & squareBB(to))
     {
-        found = movePiece(move);
-        if (found)
-        {
-            assert(undoMove());
-            return false;
-        }
+        undo_move.captured = pieceOn(to);
+        removePiece(to, undo_move.captured, !on_move);
     }
-    return true;
+    shiftPiece(from, to, piece, on_move);
+
+    castles &= CASTLE_MASKS[from] & CASTLE_MASKS[to];
+    if (piece == PAWN && std::abs(to - from) == 16)
+        enpass = (from + to) / 2;
+    else
+        enpass = -1;
+
+    pushMove(undo_move);
 }
 
-bool Board::nmovePiece(const Nmove *move)
+void Board::smovePiece(Move move)
 {
-    auto [from, to] = *move;
-    UndoNmove undo;
-    undo.from = from;
-    undo.from_field = getField(from.x, from.y);
-    undo.to = to;
-    undo.to_field = getField(to.x, to.y);
-    undo.castles = castles;
-    undo.enpass = enpass;
+    int from = moveFrom(move), to = moveTo(move);
+    UndoMove undo_move = {move, NO_PIECE, castles, enpass};
 
-    auto [x1, y1] = from;
-    char piece = getField(x1, y1);
-    setField(x1, y1, '\0');
-    auto [x2, y2] = to;
-    setField(x2, y2, piece);
-
-    if (tolower(piece) == 'k')
+    if (moveFlag(move) == ENPASS)
     {
-        if (on_move)
-            castles = castles & 0b0011;
-        else
-            castles = castles & 0b1100;
+        undo_move.captured = PAWN;
+        removePiece(on_move ? to + 8 : to - 8, PAWN, !on_move);
+        shiftPiece(from, to, PAWN, on_move);
     }
-    if (tolower(piece) == 'r')
+    else if (moveFlag(move) == CASTLE)
     {
-        if (x1 == 7){
-            if (on_move)
-                castles = castles & 0b0111;
-            else
-                castles = castles & 0b1101;
-        }
-        else if (x1 == 0){
-            if (on_move)
-                castles = castles & 0b1011;
-            else
-                castles = castles & 0b1110;
-        }
+        int rook_from = to > from ? from + 3 : from - 4;
+        int rook_to = (from + to) / 2;
+        shiftPiece(from, to, KING, on_move);
+        shiftPiece(rook_from, rook_to, ROOK, on_move);
     }
-    if (tolower(piece) == 'p' && abs(y2 - y1) == 2)
+    else
     {
-        enpass = {x1, (y1 + y2) / 2};
-    }else{
-        enpass = {-1, -1};
+        if (occupied & squareBB(to))
+        {
+            undo_move.captured = pieceOn(to);
+            removePiece(to, undo_move.captured, !on_move);
+        }
+        removePiece(from, PAWN, on_move);
+        putPiece(to, promotionPiece(move), on_move);
     }
 
-    if (isCheck())
-    {
-        castles = undo.castles;
-        enpass = undo.enpass;
-        setField(undo.to.x, undo.to.y, undo.to_field);
-        setField(undo.from.x, undo.from.y, undo.from_field);
-        return false;
-    }
+    castles &= CASTLE_MASKS[from] & CASTLE_MASKS[to];
+    enpass = -1;
 
-    undo_stack.push_back(undo);
-    on_move = !on_move;
-    return true;
+    pushMove(undo_move);
 }
 
-bool Board::smovePiece(const Smove *smove)
+/**
+ * @brief play a move, it has to be one of allMoves()
+ */
+void Board::movePiece(Move move){
+    if (moveFlag(move) == NORMAL)
+        nmovePiece(move);
+    else
+        smovePiece(move);
+}
+
+/**
+ * @brief pass the turn without moving (null move pruning); taken back with
+ * undoMove like any move. Not allowed in check.
+ */
+void Board::makeNullMove()
 {
-    auto [move1, move2] = *smove;
+    UndoMove undo_move = {NO_MOVE, NO_PIECE, castles, enpass};
+    enpass = -1;
+    pushMove(undo_move);
+}
 
-    if (!movePiece(move1))
-        return false;
-    on_move = !on_move;
-    if (!movePiece(move2)){
-        undoMove();
-        on_move = !on_move;
-        return false;
-    }
+/**
+ * @brief true if the side on move has a piece other than pawns and king;
+ * without one zugzwang is likely and a null move proves nothing
+ */
+bool Board::hasNonPawnMaterial()
+{
+    return colors[on_move] & ~(pieces[PAWN] | pieces[KING]);
+}
 
-    
-    UndoSmove undo_smove;
-    
-    undo_smove.first = std::get<UndoNmove>(undo_stack.back());
-    undo_stack.pop_back();
-    undo_smove.second = std::get<UndoNmove>(undo_stack.back());
-    undo_stack.pop_back();
+/**
+ * @brief pieces of both sides, kings included
+ */
+int Board::pieceCount()
+{
+    return popCount(occupied);
+}
 
-    undo_stack.push_back(undo_smove);
+Bitboard Board::pieceSet(Piece piece)
+{
+    return pieces[piece];
+}
 
-    return true;
+Bitboard Board::colorSet(bool white)
+{
+    return colors[white];
 }
 
-bool Board::movePiece(const Move &move){
-    if (auto* nm = std::get_if<Nmove>(&move)) {
-        return nmovePiece(nm);
-    } else if (auto* sm = std::get_if<Smove>(&move)) {
-        return smovePiece(sm);
+unsigned int Board::castleRights()
+{
+    return castles;
+}
+
+/**
+ * @brief square behind a pawn that just moved two fields, -1 if none
+ */
+int Board::enpassSquare()
+{
+    return enpass;
+}
+
+/**
+ * @brief revert a move, the side on move is the one that did not make it
+ */
+void Board::undo(const UndoMove *undo_move)
+{
+    switchSide();
+    Move move = undo_move->move;
+    int from = moveFrom(move), to = moveTo(move);
+
+    switch (move == NO_MOVE ? -1 : moveFlag(move))
+    {
+    case -1: // null move
+        break;
+    case NORMAL:
+    {
+        Piece piece = pieceOn(to);
+        shiftPiece(to, from, piece, on_move);
+        if (undo_move->captured != NO_PIECE)
+            putPiece(to, undo_move->captured, !on_move);
+        break;
+    }
+    case ENPASS:
+        shiftPiece(to, from, PAWN, on_move);
+        putPiece(on_move ? to + 8 : to - 8, PAWN, !on_move);
+        break;
+    case CASTLE:
+        shiftPiece(to, from, KING, on_move);
+        shiftPiece((from + to) / 2, to > from ? from + 3 : from - 4, ROOK, on_move);
+        break;
+    default:
+        removePiece(to, promotionPiece(move), on_move);
+        putPiece(from, PAWN, on_move);
+        if (undo_move->captured != NO_PIECE)
+            putPiece(to, undo_move->captured, !on_move);
+        break;
     }
-    return false;
+
+    unsigned int old_castles = castles;
+    int old_enpass = enpass;
+    castles = undo_move->castles;
+    enpass = undo_move->enpass;
+    updateStateKey(old_castles, old_enpass);
 }
 
-void Board::undo(const UndoNmove *undo_nmove)
-{   
-    castles = undo_nmove->castles;
-    enpass = undo_nmove->enpass;
-    setField(undo_nmove->to.x, undo_nmove->to.y, undo_nmove->to_field);
-    setField(undo_nmove->from.x, undo_nmove->from.y, undo_nmove->from_field);
-    on_move = !on_move;
+/**
+ * @brief move that led to the position, NO_MOVE at the start of the history
+ */
+Move Board::lastMove()
+{
+    return undo_stack.empty() ? NO_MOVE : undo_stack.back().move;
 }
 
 bool Board::undoMove()
-{   
+{
     if (undo_stack.size() < 1)
         return false;
 
-    if (auto* nmn = std::get_if<UndoNmove>(&undo_stack.back())) {
-        undo(nmn);
-    } else if (auto* smn = std::get_if<UndoSmove>(&undo_stack.back())) {
-        undo(&(smn->first));
-        on_move = !on_move;
-        undo(&(smn->second));
-    }
+    undo(&undo_stack.back());
     undo_stack.pop_back();
+#ifdef DEBUG
+    assert(key == computeKey());
+#endif
     return true;
 }
 
+/**
+ * @brief static evaluation in centipawns from white's point of view:
+ * the running material and piece-square totals tapered by game phase.
+ * Mate and stalemate are left to the search, which has the moves at hand.
+ */
 int Board::getScore()
 {
-    if (isMate())
-    {
-        return on_move ? -1000 : 1000;
-    }
-    else if (isStaleMate())
-    {
-        return 0;
-    }
-    int white = 0;
-    int black = 0;
-    for (size_t i = 0; i < 8; i++)
-    {
-        for (size_t j = 0; j < 8; j++)
-        {
-            char piece = getField(i, j);
-            if (VALUES.find(tolower(piece)) == VALUES.end())
-                continue;
-            if (islower(piece))
-                black += VALUES.at(tolower(piece));
-            else
-                white += VALUES.at(tolower(piece));
-        }
-    }
-    return white - black;
+    int mg_phase = std::min(phase, MAX_PHASE);
+    return (score_mg * mg_phase + score_eg * (MAX_PHASE - mg_phase)) / MAX_PHASE;
 }
 
+/**
+ * @brief static evaluation for the side on move: the network if one is
+ * loaded, otherwise the tapered piece-square score with the pawn structure
+ * evaluated from scratch
+ */
 int Board::eval()
 {
-    int eval = getScore();
+    if (NNUE.isLoaded())
+        return std::clamp(NNUE.evaluate(acc, on_move), -MAX_EVAL, MAX_EVAL);
+    return evalWith(PawnTable::compute(*this));
+}
+
+/**
+ * @brief same as eval(), with the pawn structure taken from a pawn hash table
+ */
+int Board::eval(PawnTable &pawns)
+{
+    if (NNUE.isLoaded())
+        return std::clamp(NNUE.evaluate(acc, on_move), -MAX_EVAL, MAX_EVAL);
+    return evalWith(pawns.probe(*this));
+}
+
+int Board::evalWith(const PawnEntry &pawns)
+{
+    int mg = score_mg + pawns.mg + kingShelter(*this, true) - kingShelter(*this, false);
+    int eg = score_eg + pawns.eg;
+    int mg_phase = std::min(phase, MAX_PHASE);
+    int eval = (mg * mg_phase + eg * (MAX_PHASE - mg_phase)) / MAX_PHASE;
     if (!on_move) return -eval;
     return eval;
 }
@@ -2,110 +2,132 @@
 #define BOARD_H
 
 #include <string>
-#include <map>
 #include <vector>
 #include <utility>
 #include <iostream>
+#include "bitboard.h"
+#include "move.h"
+#include "nnue.h"
 
-enum Collision {
-    OUT_OF_B = -1,
-    NO_COLL,
-    COLL,
-    OPP
-};
+class PawnTable;
+struct PawnEntry;
+
+constexpr int MATE = 32000;  // score of a mated side, mate in n plies scores MATE - n
+constexpr int MAX_PLY = 128;
+constexpr int TB_WIN_SCORE = MATE - 2 * MAX_PLY; // won endgame n plies from a probe scores TB_WIN_SCORE - n
 
 struct Coords {
     int x;
     int y;
 };
 
-struct Nmove {
-    Coords from;
-    Coords to;
-};
-
-typedef std::pair<Nmove, Nmove> Smove;
-
-typedef std::variant<Nmove, Smove> Move;
-
-struct UndoNmove {
-    Coords from;
-    char from_field;
-    Coords to;
-    char to_field;
+struct UndoMove {
+    Move move;
+    Piece captured;
     unsigned int castles;
-    Coords enpass;
+    int enpass;
 };
 
-typedef std::pair<UndoNmove, UndoNmove> UndoSmove;
-
-typedef std::variant<UndoNmove, UndoSmove> UndoMove;
-
 class Board {
 private:
-    const std::map<char, int> VALUES = {{'r', 5}, {'n', 3}, {'b', 3}, {'q', 9}, {'p', 1}, {'k', 0}};
+    static constexpr char PIECE_CHARS[7] = "pnbrqk";
 
-    char arr[64]; // [y*8 + x]
+    Bitboard pieces[6]; // indexed by Piece, both colors
+    Bitboard colors[2]; // indexed by Color, colors[on_move] are the pieces on move
+    Bitboard occupied;
+    Piece squares[64]; // piece type on each square, NO_PIECE if empty; colors tell the side
+    int kings[2];      // square of each side's king, -1: none
     unsigned int castles; // 0b1000: white ks, 0b0100 white qs, 0b0010 black ks, 0b0001 black qs
-    Coords enpass; // (x, y)
+    int enpass; // square behind a pawn that just moved two fields, -1: none
     bool on_move; // true: white, false: black
+    uint64_t key; // zobrist key, kept up to date by putPiece, removePiece, switchSide and updateStateKey
+    uint64_t pawn_key; // zobrist key of the pawns alone, for the pawn hash
+    int score_mg; // material + piece-square sum (white - black), middlegame tables
+    int score_eg; // same with endgame tables
+    int phase;    // remaining non-pawn material, MAX_PHASE at the start
+    Accumulator acc; // hidden layer of the network, only kept up to date while one is loaded
 
     std::vector<UndoMove> undo_stack;
-    std::vector<bool> undo_special;
 
     std::vector<std::string> splitFen(const std::string &str);
     char getField(int x, int y);
-    Collision isCollision(int x, int y);
-    void setField(int x, int y, char piece);
-    bool getColor(int x, int y);
-    
-    std::vector<Nmove> pMoves(Coords from);
-    std::vector<Nmove> nMoves(Coords from);
-    std::vector<Nmove> bMoves(Coords from);
-    std::vector<Nmove> rMoves(Coords from);
-    std::vector<Nmove> qMoves(Coords from);
-    std::vector<Nmove> kMoves(Coords from);
-    
-    bool nChecking(Coords from);
-    bool bChecking(Coords from, char piece = 'b');
-    bool rChecking(Coords from, char piece = 'r');
-    bool qChecking(Coords from);
-    bool pChecking(Coords from);
-    
-    Coords getKingOnMove();
-    
-    std::vector<Nmove> normalMoves();
-    std::vector<Smove> specialMoves();
-    
-    void undo(const UndoNmove *undo_nmove);
-    
-    bool smovePiece(const Smove *smove);
-    bool nmovePiece(const Nmove *nmove);
-
-    
-    static std::string descNmove(const Nmove *nmv);
-    static std::string descSmove(const Smove *smv);
+
+    void putPiece(int sq, Piece piece, bool white);
+    void removePiece(int sq, Piece piece, bool white);
+    void shiftPiece(int from, int to, Piece piece, bool white);
+    void switchSide();
+    void updateStateKey(unsigned int old_castles, int old_enpass);
+    uint64_t computeKey();
+    int evalWith(const PawnEntry &pawns);
+
+    static void addMoves(MoveList &moves, int from, Bitboard targets);
+    void pMoves(MoveList &moves, int from, Bitboard allowed);
+    void nMoves(MoveList &moves, int from, Bitboard allowed);
+    void bMoves(MoveList &moves, int from, Bitboard allowed);
+    void rMoves(MoveList &moves, int from, Bitboard allowed);
+    void qMoves(MoveList &moves, int from, Bitboard allowed);
+    void kMoves(MoveList &moves, int from, Bitboard allowed);
+
+    Bitboard attackersTo(int sq, Bitboard occ);
+    bool isAttacked(int sq);
+    Bitboard pinnedPieces(int king);
+
+    int getKingOnMove();
+
+    void normalMoves(MoveList &moves, int king, Bitboard allowed, Bitboard pinned,
+                     Bitboard pawn_allowed = ~Bitboard(0));
+    void enpassMoves(MoveList &moves, int king);
+    void castleMoves(MoveList &moves, int king);
+    void specialMoves(MoveList &moves, int king, Bitboard checkers);
+    void evasionMoves(MoveList &moves, int king, Bitboard checkers, Bitboard pinned);
+
+    void undo(const UndoMove *undo_move);
+    void pushMove(const UndoMove &undo_move);
+
+    void smovePiece(Move move);
+    void nmovePiece(Move move);
 
 public:
     Board(std::string fen = "");
     Board(const Board &other);
-    
+    Board &operator=(const Board &other);
+
     friend std::ostream &operator<<(std::ostream &os, Board &bd);
 
     static std::string descField(Coords coords);
-    static std::string descMove(const Move &move);
+    static std::string descMove(Move move);
+    static std::string descUci(Move move);
     void readFen(std::string fen);
+    Move parseUci(const std::string &uci);
+    Piece pieceOn(int sq);
+    int kingSquare(bool white);
+    Move lastMove();
     bool onMove();
-    std::vector<Move> allMoves();
-    std::vector<Nmove> getMoves(Coords from);
-
-    bool isCheck(Coords from = {-1, -1});
+    uint64_t getKey();
+    uint64_t pawnKey();
+    uint64_t polyglotKey(const uint64_t *random);
+    void allMoves(MoveList &moves);
+    void captureMoves(MoveList &moves);
+    void quietMoves(MoveList &moves);
+    bool isLegal(Move move);
+    int see(Move move);
+    void getMoves(MoveList &moves, Coords from);
+
+    bool isCheck();
     bool isMate();
     bool isStaleMate();
-    bool movePiece(const Move &move);
+    void movePiece(Move move);
+    void makeNullMove();
     bool undoMove();
+    bool hasNonPawnMaterial();
+    int pieceCount();
+    Bitboard pieceSet(Piece piece);
+    Bitboard colorSet(bool white);
+    unsigned int castleRights();
+    int enpassSquare();
     int getScore();
     int eval();
+    int eval(PawnTable &pawns);
 };
 
 #endif // BOARD_H
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <string>
+#include <random>
+#include "board.h"
+
+/**
+ * Polyglot opening book (.bin). The file is memory-mapped and searched in
+ * place: 16-byte big-endian entries {key, move, weight, learn} sorted by key.
+ * Positions are looked up by their Polyglot key, built from the format's
+ * fixed Random64 table.
+ */
+class Book {
+private:
+    static constexpr int ENTRY_SIZE = 16;
+
+    const unsigned char *data = nullptr;
+    size_t entries = 0;
+    size_t map_size = 0;
+    bool best = false; // highest weight instead of a weighted draw
+    std::mt19937_64 rng{std::random_device{}()};
+
+    uint64_t keyAt(size_t index) const;
+    static Move decodeMove(Board &bd, unsigned int move);
+
+public:
+    Book() = default;
+    Book(const Book &) = delete;
+    Book &operator=(const Book &) = delete;
+    ~Book();
+
+    bool open(const std::string &path);
+    void close();
+    void setBest(bool best_only);
+    bool ready() const;
+    Move probe(Board &bd);
+    static uint64_t key(Board &bd);
+};
+
+#endif // BOOK_H
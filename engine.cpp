@@ -1,67 +1,750 @@
 #include "engine.h"
+#include "alloc.h"
+#include "movepick.h"
+#include "psqt.h"
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <array>
+#include <cmath>
+#include <sstream>
 
-Engine::Engine(std::string fen) : bd(fen) {}
+static constexpr int TIME_CHECK_NODES = 2048; // power of two, nodes between clock reads
+static constexpr int MOVE_OVERHEAD = 10;      // ms kept back for output and I/O lag
+static constexpr int INFO_INTERVAL = 1000;    // ms between UCI info lines within an iteration
+static constexpr int ASPIRATION_DEPTH = 4;    // first depth searched with a window
+static constexpr int ASPIRATION_DELTA = 25;   // initial half window in centipawns
+
+static constexpr int DELTA_MARGIN = 200; // quiescence: positional slack on top of the captured piece
+
+// selective search
+static constexpr int RFP_DEPTH = 6;         // reverse futility up to this depth
+static constexpr int RFP_MARGIN = 80;       // per ply of depth
+static constexpr int FUTILITY_DEPTH = 3;    // futility pruning up to this depth
+static constexpr int FUTILITY_MARGIN[FUTILITY_DEPTH + 1] = {0, 150, 300, 450};
+static constexpr int NULL_MIN_DEPTH = 3;
+static constexpr int LMR_MIN_DEPTH = 3;
+static constexpr int LMR_MIN_MOVE = 3;      // the first moves are never reduced
+
+/**
+ * @brief late move reduction in plies for a depth and move number,
+ * 0.75 + ln(depth) * ln(move) / 2.25
+ */
+static const auto LMR_TABLE = [] {
+    std::array<std::array<int, 64>, 64> table{};
+    for (int depth = 1; depth < 64; depth++)
+        for (int move = 1; move < 64; move++)
+            table[depth][move] = int(0.75 + std::log(depth) * std::log(move) / 2.25);
+    return table;
+}();
+
+void SearchThread::clearOrdering()
+{
+    for (auto &ss : stack)
+        ss.killers[0] = ss.killers[1] = NO_MOVE;
+    for (auto &side : history)
+        for (auto &from : side)
+            for (int &value : from)
+                value = 0;
+    for (auto &from : countermoves)
+        for (Move &move : from)
+            move = NO_MOVE;
+}
+
+Engine::Engine(std::string fen) : bd(fen), flags(0b11)
+{
+    setThreads(1);
+}
 
 Engine::Engine(std::string fen, std::vector<std::string> _flags) : bd(fen)
 {
     flags = 0b11;
+    int thread_count = 1;
     for (const auto &flag : _flags)
     {
         if (flag == "noprint")
-            flags &= 0b10;
+            flags &= ~0b01u;
         else if (flag == "noclock")
-            flags &= 0b01;
+            flags &= ~0b10u;
+        else if (flag == "uci")
+            flags |= 0b100;
+        else if (flag == "nopvs")
+            features.pvs = false;
+        else if (flag == "nonull")
+            features.null_move = false;
+        else if (flag == "nolmr")
+            features.lmr = false;
+        else if (flag == "norfp")
+            features.reverse_futility = false;
+        else if (flag == "nofutility")
+            features.futility = false;
+        else if (flag == "noext")
+            features.check_extension = false;
+        else if (flag.rfind("hash=", 0) == 0)
+            tt.resize(std::stoul(flag.substr(5)));
+        else if (flag.rfind("threads=", 0) == 0)
+            thread_count = std::max(1, std::stoi(flag.substr(8)));
+        else if (flag.rfind("movetime=", 0) == 0)
+            limits.movetime = std::stoi(flag.substr(9));
+        else if (flag.rfind("time=", 0) == 0)
+            limits.time = std::stoi(flag.substr(5));
+        else if (flag.rfind("inc=", 0) == 0)
+            limits.inc = std::stoi(flag.substr(4));
+        else if (flag.rfind("movestogo=", 0) == 0)
+            limits.movestogo = std::stoi(flag.substr(10));
+        else if (flag.rfind("book=", 0) == 0)
+            setBook(flag.substr(5));
+        else if (flag == "bookbest")
+            book.setBest(true);
+        else if (flag.rfind("syzygy=", 0) == 0)
+            setSyzygy(flag.substr(7));
+        else if (flag.rfind("syzygylimit=", 0) == 0)
+            setSyzygyLimit(std::stoi(flag.substr(12)));
     }
+    setThreads(thread_count);
 }
 
-std::pair<int, std::vector<Move>> Engine::getBest(
-    Board &bd, int depth, int alpha = -1000, int beta = 1000)
+Engine::~Engine()
 {
-    if (depth == 0) {
-        return {bd.eval(), {}};
+    stopHelpers();
+}
+
+void Engine::stopHelpers()
+{
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        quit = true;
     }
+    pool_cv.notify_all();
+    for (auto &helper : helpers)
+        helper.join();
+    helpers.clear();
+    quit = false;
+}
+
+/**
+ * @brief resize the search pool; helpers stay parked between searches
+ * @param count number of search threads including the calling one
+ */
+void Engine::setThreads(int count)
+{
+    stopHelpers();
+    threads.clear();
+    threads.reserve(count); // a reallocation would copy the reserved pv vectors without their capacity
+    for (int i = 0; i < count; i++)
+        threads.emplace_back(i, bd);
+    for (int i = 1; i < count; i++)
+        helpers.emplace_back(&Engine::helperLoop, this, i);
+}
+
+/**
+ * @return false if the memory is not available, the old table is kept
+ */
+bool Engine::setHash(size_t mb)
+{
+    return tt.resize(mb);
+}
+
+void Engine::clearHash()
+{
+    tt.clear();
+}
+
+/**
+ * @brief open a Polyglot book
+ * @return false (with a message on stderr) if the file cannot be mapped
+ */
+bool Engine::setBook(const std::string &path)
+{
+    if (book.open(path))
+        return true;
+    std::cerr << "cannot open book " << path << "\n";
+    return false;
+}
+
+void Engine::setBookBest(bool best)
+{
+    book.setBest(best);
+}
+
+/**
+ * @brief book move for the current position, NO_MOVE if out of book
+ */
+Move Engine::bookMove()
+{
+    return book.probe(bd);
+}
+
+/**
+ * @brief load Syzygy tables from path (directories separated by ':')
+ * @return false (with a message on stderr) if none could be loaded
+ */
+bool Engine::setSyzygy(const std::string &path)
+{
+    bool loaded = Syzygy::init(path);
+    if (!loaded)
+        std::cerr << "no Syzygy tables loaded from " << path << "\n";
+    setSyzygyLimit(tb_limit);
+    return loaded;
+}
+
+/**
+ * @brief probe only positions with at most this many pieces, 0 turns probing off
+ */
+void Engine::setSyzygyLimit(int pieces)
+{
+    tb_limit = std::max(0, pieces);
+    tb_pieces = std::min(tb_limit, Syzygy::largest());
+}
+
+/**
+ * @brief move of the current position that keeps its tablebase result and
+ * makes the fastest progress (DTZ), NO_MOVE if the position is not in the tables
+ */
+Move Engine::tablebaseMove(TablebaseResult &result, int &dtz)
+{
+    if (bd.pieceCount() > tb_pieces)
+        return NO_MOVE;
+    return Syzygy::probeRoot(bd, result, dtz);
+}
+
+/**
+ * @brief position searched by the next startSearch; the search threads
+ * take their copies when it starts
+ */
+void Engine::setPosition(const Board &position)
+{
+    bd = position;
+}
+
+void Engine::helperLoop(int id)
+{
+    unsigned int seen = 0;
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    while (true)
+    {
+        pool_cv.wait(lock, [&] { return quit || search_id != seen; });
+        if (quit)
+            return;
+        seen = search_id;
+        lock.unlock();
 
-    std::vector<Move> moves = bd.allMoves();
+        iterate(threads[id], search_depth);
 
-    if (moves.empty()) {
-        return {bd.eval(), {}};
+        lock.lock();
+        if (--running == 0)
+            done_cv.notify_all();
     }
+}
+
+/**
+ * @brief turn the limits into deadlines counted from start_time.
+ * A fixed move time is used as a whole. On a clock the move gets its
+ * share of the remaining time plus most of the increment (soft), and may
+ * overrun that up to 3x to finish an iteration (hard). Both stop at half of
+ * what is left after the overhead, so a large increment on a nearly empty
+ * clock cannot spend the whole clock.
+ */
+void Engine::setDeadlines()
+{
+    using ms = std::chrono::milliseconds;
+    timed = limits.movetime > 0 || limits.time > 0;
+    if (limits.movetime > 0)
+    {
+        int budget = std::max(1, limits.movetime - MOVE_OVERHEAD);
+        soft_deadline = hard_deadline = start_time + ms(budget);
+    }
+    else if (limits.time > 0)
+    {
+        int left = std::max(1, limits.time - MOVE_OVERHEAD);
+        int moves_left = limits.movestogo > 0 ? std::min(limits.movestogo, 30) : 30;
+        int soft = std::max(1, std::min(left / moves_left + limits.inc * 3 / 4, left / 2));
+        int hard = std::max(soft, std::min(soft * 3, left / 2));
+        soft_deadline = start_time + ms(soft);
+        hard_deadline = start_time + ms(hard);
+    }
+}
+
+/**
+ * @brief raise the stop flag once the hard deadline has passed; the clock
+ * is read every TIME_CHECK_NODES nodes of the main thread, and not before
+ * the first iteration is complete so there is always a move to play.
+ * In UCI mode this is also where long iterations report progress.
+ */
+void Engine::checkTime(const SearchThread &th)
+{
+    if (th.id != 0 || th.depth == 0)
+        return;
+    if (limits.nodes > 0 && th.nodes >= limits.nodes)
+        stop = true;
+    bool uci = flags & 0b100;
+    if ((!timed && !uci) || (th.nodes & (TIME_CHECK_NODES - 1)) != 0)
+        return;
+    auto now = std::chrono::steady_clock::now();
+    if (timed && now >= hard_deadline)
+        stop = true;
+    if (uci && now >= next_info)
+        printProgress(now);
+}
+
+/**
+ * @brief write a line (or several) to stdout and flush; one lock covers the
+ * searcher's info and bestmove lines and the replies to GUI commands, so
+ * that they never interleave
+ */
+void Engine::send(const std::string &text)
+{
+    static std::mutex output_mutex;
+    std::lock_guard<std::mutex> lock(output_mutex);
+    std::cout << text << std::endl;
+}
+
+bool Engine::isMateScore(int score)
+{
+    return std::abs(score) >= MATE - MAX_PLY;
+}
 
-    int best_score = -100000;
-    std::vector<Move> b_moves;
+/**
+ * @brief full moves to the mate a score announces, negative when the side
+ * on move is the one mated
+ */
+int Engine::mateMoves(int score)
+{
+    int plies = MATE - std::abs(score);
+    return score > 0 ? (plies + 1) / 2 : -plies / 2;
+}
 
-    for (const auto &move : moves) {
-        if (!bd.movePiece(move)) continue;
+/**
+ * @brief nodes of all search threads; safe while they run
+ */
+uint64_t Engine::totalNodes() const
+{
+    uint64_t nodes = 0;
+    for (const auto &th : threads)
+        nodes += th.nodes;
+    return nodes;
+}
 
-        auto [score, c_moves] = getBest(bd, depth - 1, -beta, -alpha);
-        score = -score;
+/**
+ * @brief UCI info line of a completed iteration; mate scores are given
+ * in moves, negative when the side to move is mated
+ */
+void Engine::printInfo(const SearchThread &th)
+{
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time).count();
+    uint64_t nodes = totalNodes();
+    std::string line = "info depth " + std::to_string(th.depth);
+    STAT(line += " seldepth " + std::to_string(th.stats.seldepth.get()));
+    line += " score ";
+    if (isMateScore(th.score))
+        line += "mate " + std::to_string(mateMoves(th.score));
+    else
+        line += "cp " + std::to_string(th.score);
+    line += " nodes " + std::to_string(nodes) + " nps " + std::to_string(nodes * 1000 / std::max<int64_t>(elapsed, 1)) +
+            " time " + std::to_string(elapsed);
+    if (tb_pieces)
+        line += " tbhits " + std::to_string(th.tb_hits.get());
+    line += " pv";
+    for (Move move : th.pv)
+        line += " " + Board::descUci(move);
+    send(line);
+}
+
+/**
+ * @brief UCI info line while an iteration is still running: the depth
+ * being searched and the counters so far
+ */
+void Engine::printProgress(std::chrono::steady_clock::time_point now)
+{
+    next_info = now + std::chrono::milliseconds(INFO_INTERVAL);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time).count();
+    uint64_t nodes = totalNodes();
+    std::string line = "info depth " + std::to_string(threads[0].depth + 1);
+    STAT(line += " seldepth " + std::to_string(threads[0].stats.seldepth.get()));
+    line += " nodes " + std::to_string(nodes) + " nps " + std::to_string(nodes * 1000 / std::max<int64_t>(elapsed, 1)) +
+            " time " + std::to_string(elapsed) + " hashfull " + std::to_string(tt.hashfull());
+    send(line);
+}
+
+/**
+ * @brief counters of the last search summed over its threads, as one JSON
+ * object; with NO_STATS only nodes, time, depth and tbhits are left
+ */
+std::string Engine::statsJson() const
+{
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    uint64_t nodes = totalNodes();
+    int depth = 0;
+    for (const auto &th : threads)
+        depth = std::max(depth, th.depth);
+    std::ostringstream os;
+    os << "{\"time_ms\": " << static_cast<uint64_t>(elapsed) << ", \"depth\": " << depth
+       << ", \"nodes\": " << nodes << ", \"nps\": " << static_cast<uint64_t>(nodes * 1000 / std::max(elapsed, 1.0));
+#ifndef NO_STATS
+    uint64_t qnodes = 0, cutoffs = 0, first_cutoffs = 0, tt_probes = 0, tt_hits = 0, seldepth = 0;
+    uint64_t reductions = 0, researches = 0, pawn_probes = 0, pawn_hits = 0;
+    for (const auto &th : threads)
+    {
+        qnodes += th.stats.qnodes;
+        cutoffs += th.stats.cutoffs;
+        first_cutoffs += th.stats.first_cutoffs;
+        tt_probes += th.stats.tt_probes;
+        tt_hits += th.stats.tt_hits;
+        seldepth = std::max<uint64_t>(seldepth, th.stats.seldepth);
+        reductions += th.stats.reductions;
+        researches += th.stats.researches;
+        pawn_probes += th.pawns.probeCount();
+        pawn_hits += th.pawns.hitCount();
+    }
+    os << ", \"qnodes\": " << qnodes << ", \"seldepth\": " << seldepth << ", \"cutoffs\": " << cutoffs
+       << ", \"first_move_cutoff_rate\": " << (cutoffs ? double(first_cutoffs) / cutoffs : 0.0)
+       << ", \"tt_probes\": " << tt_probes << ", \"tt_hits\": " << tt_hits
+       << ", \"tt_hit_rate\": " << (tt_probes ? double(tt_hits) / tt_probes : 0.0)
+       << ", \"reductions\": " << reductions << ", \"researches\": " << researches
+       << ", \"pawn_probes\": " << pawn_probes << ", \"pawn_hits\": " << pawn_hits
+       << ", \"pawn_hit_rate\": " << (pawn_probes ? double(pawn_hits) / pawn_probes : 0.0);
+#endif
+    if (tb_pieces)
+    {
+        uint64_t tb_hits = 0;
+        for (const auto &th : threads)
+            tb_hits += th.tb_hits;
+        os << ", \"tbhits\": " << tb_hits;
+    }
+    os << "}";
+    return os.str();
+}
+
+/**
+ * @brief whether a thread must give up its search: the stop flag is up,
+ * but the main thread always completes depth 1 first so that even an
+ * immediate stop leaves a move to play
+ */
+bool Engine::aborted(const SearchThread &th) const
+{
+    return stop && (th.id != 0 || th.depth > 0);
+}
+
+/**
+ * @brief root search in a window around the score of the previous
+ * iteration, widened on the failing side until the score falls inside
+ */
+int Engine::aspiration(SearchThread &th, int depth)
+{
+    if (depth < ASPIRATION_DEPTH || std::abs(th.score) >= MATE - MAX_PLY)
+        return getBest(th, depth, 0, -MATE, MATE);
+
+    int delta = ASPIRATION_DELTA;
+    int alpha = std::max(th.score - delta, -MATE);
+    int beta = std::min(th.score + delta, MATE);
+    while (true)
+    {
+        int score = getBest(th, depth, 0, alpha, beta);
+        if (aborted(th))
+            return score;
+        if (score <= alpha && alpha > -MATE)
+            alpha = std::max(score - delta, -MATE);
+        else if (score >= beta && beta < MATE)
+            beta = std::min(score + delta, MATE);
+        else
+            return score;
+        delta *= 2;
+    }
+}
+
+/**
+ * @brief iterative deepening of one thread; a helper skips every other
+ * depth depending on its id and may go one ply past the target, so the
+ * threads spread over different depths and fill the shared table for
+ * each other. An iteration cut by the stop flag is dropped, the thread
+ * keeps the result of the last one it completed; the main thread's first
+ * iteration is never cut.
+ */
+void Engine::iterate(SearchThread &th, int max_depth)
+{
+    int last = th.id == 0 ? max_depth : std::min(max_depth + (th.id & 1), MAX_PLY - 1);
+    for (int depth = 1; depth <= last && !aborted(th); depth++)
+    {
+        if (th.id > 0 && depth < max_depth && (depth + th.id) % 2 == 0)
+            continue;
+        int score = aspiration(th, depth);
+        if (aborted(th))
+            break;
+        th.depth = depth;
+        th.score = score;
+        th.pv.assign(th.stack[0].pv, th.stack[0].pv + th.stack[0].pv_length);
+        if (th.id == 0 && (flags & 0b100))
+            printInfo(th);
+        if (th.id == 0 && timed && std::chrono::steady_clock::now() >= soft_deadline)
+            break;
+    }
+}
+
+/**
+ * @brief learn from a beta cutoff by a quiet move: it becomes a killer and
+ * the countermove of the previous move, its history grows and the history
+ * of the quiets searched before it shrinks
+ * @param tried quiet moves searched before the one that cut off
+ */
+void Engine::updateOrdering(SearchThread &th, Move move, const MoveList &tried, int depth, int ply)
+{
+    Board &bd = th.bd;
+    if (bd.pieceOn(moveTo(move)) != NO_PIECE || moveFlag(move) == ENPASS || isPromotion(move))
+        return;
+
+    Move *killers = th.stack[ply].killers;
+    if (killers[0] != move)
+    {
+        killers[1] = killers[0];
+        killers[0] = move;
+    }
+    Move prev = bd.lastMove();
+    if (prev)
+        th.countermoves[moveFrom(prev)][moveTo(prev)] = move;
+
+    // gravity update: the closer to MAX_HISTORY the smaller the step
+    bool side = bd.onMove();
+    int bonus = std::min(depth * depth, MAX_HISTORY);
+    auto adjust = [&](Move m, int delta) {
+        int &value = th.history[side][moveFrom(m)][moveTo(m)];
+        value += delta - value * std::abs(delta) / MAX_HISTORY;
+    };
+    adjust(move, bonus);
+    for (Move quiet : tried)
+        adjust(quiet, -bonus);
+}
+
+/**
+ * @brief principal variation search of the position of th.bd. Nodes off
+ * the principal variation may be cut by reverse futility or a null move,
+ * quiet moves near the leaves by futility, and late quiet moves are
+ * searched reduced; a side in check is searched one ply deeper.
+ * @return score from the side on move; the variant is left in th.stack[ply].pv
+ */
+int Engine::getBest(SearchThread &th, int depth, int ply, int alpha, int beta)
+{
+    Board &bd = th.bd;
+    bool in_check = bd.isCheck();
+    if (in_check && features.check_extension)
+        depth++;
+    if (depth <= 0)
+        return quiesce(th, ply, alpha, beta);
+
+    SearchStack &ss = th.stack[ply];
+    ss.pv_length = 0;
+    th.nodes++;
+    STAT(th.stats.seldepth.raise(ply + 1));
+    checkTime(th);
+    ss.static_eval = bd.eval(th.pawns);
+    if (ply >= MAX_PLY - 1)
+        return ss.static_eval;
+    bool pv_node = beta - alpha > 1;
+
+    TTData tt_data;
+    Move tt_move = NO_MOVE;
+    bool tt_hit = tt.probe(bd.getKey(), tt_data);
+    STAT(th.stats.tt_probes++);
+    STAT(if (tt_hit) th.stats.tt_hits++);
+    if (tt_hit)
+        tt_move = tt_data.move;
+    if (ply > 0 && tt_hit && tt_data.depth >= depth) {
+        int tt_score = TranspositionTable::scoreFromTT(tt_data.score, ply);
+        if (tt_data.bound == BOUND_EXACT ||
+            (tt_data.bound == BOUND_LOWER && tt_score >= beta) ||
+            (tt_data.bound == BOUND_UPPER && tt_score <= alpha)) {
+            if (tt_move) {
+                ss.pv[0] = tt_move;
+                ss.pv_length = 1;
+            }
+            return tt_score;
+        }
+    }
+
+    // the tables know the result, nothing below this node can change it
+    if (ply > 0 && bd.pieceCount() <= tb_pieces) {
+        TablebaseResult wdl;
+        if (Syzygy::probeWdl(bd, wdl)) {
+            th.tb_hits++;
+            int score = wdl == WDL_WIN ? TB_WIN_SCORE - ply : wdl == WDL_LOSS ? -TB_WIN_SCORE + ply : 0;
+            tt.store(bd.getKey(), NO_MOVE, TranspositionTable::scoreToTT(score, ply), std::min(depth + 6, MAX_PLY - 1),
+                     BOUND_EXACT);
+            return score;
+        }
+    }
+
+    bool mate_window = std::abs(beta) >= MATE - MAX_PLY;
+    if (!pv_node && !in_check && !mate_window) {
+        // so far above beta that no quiet move will bring it back
+        if (features.reverse_futility && depth <= RFP_DEPTH &&
+            ss.static_eval - RFP_MARGIN * depth >= beta)
+            return ss.static_eval;
+
+        // give the opponent a free move: if a reduced search still fails
+        // high the node would too. Never twice in a row, and not with only
+        // pawns left, where zugzwang makes passing the best move.
+        bool after_null = ply > 0 && th.stack[ply - 1].move == NO_MOVE;
+        if (features.null_move && depth >= NULL_MIN_DEPTH && ss.static_eval >= beta &&
+            !after_null && bd.hasNonPawnMaterial()) {
+            int reduction = 3 + depth / 6;
+            ss.move = NO_MOVE;
+            bd.makeNullMove();
+            int score = -getBest(th, depth - 1 - reduction, ply + 1, -beta, -beta + 1);
+            bd.undoMove();
+            if (aborted(th))
+                return 0;
+            if (score >= beta)
+                return score >= MATE - MAX_PLY ? beta : score;
+        }
+    }
+
+    MovePicker picker(th, ply, tt_move, in_check);
+    // helpers try the first plies in a different order than the main thread
+    if (th.id > 0 && ply < 2)
+        picker.rotate(th.id);
+
+    bool futile = features.futility && !pv_node && !in_check && depth <= FUTILITY_DEPTH &&
+                  ss.static_eval + FUTILITY_MARGIN[depth] <= alpha;
+    int alpha_orig = alpha;
+    int best_score = -MATE - 1;
+    Move best_move = NO_MOVE;
+    const SearchStack &child = th.stack[ply + 1];
+    MoveList quiets_tried;
+
+    int i = 0;
+    for (Move move = picker.next(); move != NO_MOVE; move = picker.next(), i++) {
+        bool quiet = bd.pieceOn(moveTo(move)) == NO_PIECE && moveFlag(move) != ENPASS && !isPromotion(move);
+        ss.move = move;
+        bd.movePiece(move);
+        bool gives_check = bd.isCheck();
+
+        if (futile && quiet && !gives_check && best_move != NO_MOVE) {
+            bd.undoMove();
+            quiets_tried.add(move);
+            continue;
+        }
+
+        int reduction = 0;
+        if (features.lmr && depth >= LMR_MIN_DEPTH && i >= LMR_MIN_MOVE && quiet && !in_check && !gives_check) {
+            reduction = LMR_TABLE[std::min(depth, 63)][std::min(i, 63)] - pv_node;
+            reduction = std::clamp(reduction, 0, depth - 2);
+            STAT(if (reduction > 0) th.stats.reductions++);
+        }
+
+        // the first move gets the full window, the rest only have to show
+        // they are not better than alpha and are searched again if they are
+        bool full_window = i == 0 || !features.pvs;
+        int child_alpha = full_window ? -beta : -alpha - 1;
+        int score = -getBest(th, depth - 1 - reduction, ply + 1, child_alpha, -alpha);
+        if (score > alpha && reduction > 0) {
+            STAT(th.stats.researches++);
+            score = -getBest(th, depth - 1, ply + 1, child_alpha, -alpha);
+        }
+        if (!full_window && score > alpha && score < beta) {
+            STAT(th.stats.researches++);
+            score = -getBest(th, depth - 1, ply + 1, -beta, -alpha);
+        }
 
         bd.undoMove();
+        if (aborted(th))
+            return 0;
 
         if (score > best_score) {
             best_score = score;
+            best_move = move;
 
-            b_moves.clear();
-            b_moves.push_back(move);
-            b_moves.insert(b_moves.end(), c_moves.begin(), c_moves.end());
+            ss.pv[0] = move;
+            std::copy(child.pv, child.pv + child.pv_length, ss.pv + 1);
+            ss.pv_length = child.pv_length + 1;
         }
 
         alpha = std::max(alpha, score);
         if (alpha >= beta) {
-            break; 
+            STAT(th.stats.cutoffs++; if (i == 0) th.stats.first_cutoffs++);
+            updateOrdering(th, move, quiets_tried, depth, ply);
+            break;
         }
+        if (quiet)
+            quiets_tried.add(move);
     }
 
-    if (best_score == -100000) {
-        return {bd.eval(), {}};
+    // every move is searched until one is best, futility only skips later ones
+    if (best_move == NO_MOVE) {
+        return in_check ? -MATE + ply : 0;
     }
 
-    return {best_score, b_moves};
+    Bound bound = best_score <= alpha_orig ? BOUND_UPPER : best_score >= beta ? BOUND_LOWER : BOUND_EXACT;
+    tt.store(bd.getKey(), best_move, TranspositionTable::scoreToTT(best_score, ply), depth, bound);
+
+    return best_score;
 }
 
-std::string Engine::moveAndPrint(Board &bd, const Move &b_move)
+/**
+ * @brief search captures only until the position is quiet, so a leaf is not
+ * scored with a piece hanging. The side on move may stand pat on the static
+ * eval; captures that cannot lift it to alpha even with a margin (delta
+ * pruning) or that lose material by SEE are skipped. In check all
+ * evasions are searched, which is also where mates at the horizon are found.
+ */
+int Engine::quiesce(SearchThread &th, int ply, int alpha, int beta)
+{
+    Board &bd = th.bd;
+    SearchStack &ss = th.stack[ply];
+    ss.pv_length = 0;
+    th.nodes++;
+    STAT(th.stats.qnodes++; th.stats.seldepth.raise(ply + 1));
+    checkTime(th);
+    ss.static_eval = bd.eval(th.pawns);
+    if (ply >= MAX_PLY - 1)
+        return ss.static_eval;
+
+    bool in_check = bd.isCheck();
+    int best_score = -MATE + ply;
+    if (!in_check) {
+        best_score = ss.static_eval;
+        if (best_score >= beta)
+            return best_score;
+        alpha = std::max(alpha, best_score);
+    }
+
+    MovePicker picker(th, ply, NO_MOVE, in_check, false);
+    const SearchStack &child = th.stack[ply + 1];
+
+    for (Move move = picker.next(); move != NO_MOVE; move = picker.next()) {
+        if (!in_check) {
+            if (isPromotion(move) && promotionPiece(move) != QUEEN)
+                continue;
+            Piece victim = moveFlag(move) == ENPASS ? PAWN : bd.pieceOn(moveTo(move));
+            int gain = victim != NO_PIECE ? PIECE_VALUES[victim] : 0;
+            if (isPromotion(move))
+                gain += PIECE_VALUES[QUEEN] - PIECE_VALUES[PAWN];
+            if (ss.static_eval + gain + DELTA_MARGIN <= alpha)
+                continue;
+            if (bd.see(move) < 0)
+                continue;
+        }
+
+        ss.move = move;
+        bd.movePiece(move);
+        int score = -quiesce(th, ply + 1, -beta, -alpha);
+        bd.undoMove();
+        if (aborted(th))
+            return 0;
+
+        if (score > best_score) {
+            best_score = score;
+            ss.pv[0] = move;
+            std::copy(child.pv, child.pv + child.pv_length, ss.pv + 1);
+            ss.pv_length = child.pv_length + 1;
+        }
+        alpha = std::max(alpha, score);
+        if (alpha >= beta)
+            break;
+    }
+    return best_score;
+}
+
+std::string Engine::moveAndPrint(Board &bd, Move b_move)
 {
     bd.movePiece(b_move);
     return Board::descMove(b_move);
@@ -86,7 +769,7 @@ void Engine::printResult(Board bd, int score, const std::vector<Move> &b_moves)
     Engine::printMoves(bd, b_moves);
 }
 
-void Engine::printResult(Board bd, int score, const Move &bmove)
+void Engine::printResult(Board bd, int score, Move bmove)
 {
     std::cout << "best variant: " << score << "\n";
     std::cout << "first move: " << moveAndPrint(bd, bmove) << "\n";
@@ -94,9 +777,99 @@ void Engine::printResult(Board bd, int score, const Move &bmove)
 
 void Engine::findBestVariant(int depth)
 {
-    clock_t start = clock();
+    SearchLimits search_limits = limits;
+    search_limits.depth = depth;
+    findBestVariant(search_limits);
+}
+
+/**
+ * @brief set the clock and wake the helpers on the current position;
+ * the caller continues with finishSearch, possibly on another thread
+ */
+void Engine::startSearch(const SearchLimits &search_limits)
+{
+    start_time = std::chrono::steady_clock::now();
+    next_info = start_time + std::chrono::milliseconds(INFO_INTERVAL);
+    limits = search_limits;
+    setDeadlines();
+    int depth = limits.depth > 0 ? std::min(limits.depth, MAX_PLY - 1) : MAX_PLY - 1;
+
+    tt.newSearch();
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        for (auto &th : threads)
+        {
+            th.bd = bd;
+            th.depth = 0;
+            th.pv.clear();
+            th.nodes = 0;
+            th.tb_hits = 0;
+            th.stats.reset();
+            th.pawns.resetStats();
+            th.clearOrdering();
+        }
+        stop = false;
+        search_depth = depth;
+        running = threads.size() - 1;
+        search_id++;
+    }
+    pool_cv.notify_all();
+}
+
+/**
+ * @brief run the main thread until a limit or stopSearch ends it
+ * @return thread holding the deepest completed iteration, the main thread on ties
+ */
+const SearchThread &Engine::finishSearch()
+{
+    iterate(threads[0], search_depth);
+    stop = true;
+    {
+        std::unique_lock<std::mutex> lock(pool_mutex);
+        done_cv.wait(lock, [&] { return running == 0; });
+    }
+
+    const SearchThread *best = &threads[0];
+    for (const auto &th : threads)
+    {
+        if (th.depth > best->depth)
+            best = &th;
+    }
+    if (flags & 0b100)
+        send("info string stats " + statsJson());
+    return *best;
+}
+
+void Engine::stopSearch()
+{
+    stop = true;
+}
+
+void Engine::findBestVariant(const SearchLimits &search_limits)
+{
+    Move book_move = bookMove();
+    if (book_move != NO_MOVE)
+    {
+        std::cout << "book move: " << Board::descMove(book_move) << "\n";
+        return;
+    }
+    TablebaseResult wdl;
+    int dtz;
+    Move tb_move = tablebaseMove(wdl, dtz);
+    if (tb_move != NO_MOVE)
+    {
+        static const char *RESULTS[3] = {"loss", "draw", "win"};
+        std::cout << "tablebase move: " << Board::descMove(tb_move) << " (" << RESULTS[wdl + 1]
+                  << ", dtz " << dtz << ")\n";
+        return;
+    }
 
-    auto [score, b_moves] = getBest(bd, depth);
+    uint64_t allocs = allocationCount();
+    startSearch(search_limits);
+    const SearchThread *best = &finishSearch();
+    allocs = allocationCount() - allocs;
+    int score = best->score;
+    const std::vector<Move> &b_moves = best->pv;
     if(!bd.onMove()) score = -score;
 
     if (flags & 0b01)
@@ -104,10 +877,17 @@ void Engine::findBestVariant(int depth)
     else
         printResult(bd, score, b_moves[0]);
 
-    clock_t end = clock();
+    auto end = std::chrono::steady_clock::now();
     if (flags & 0b10)
     {
-        double elapsed_time = double(end - start) / CLOCKS_PER_SEC;
+        double elapsed_time = std::chrono::duration<double>(end - start_time).count();
+        std::cout << "depth: " << best->depth << "\n";
         std::cout << "time : " << elapsed_time << " s" << "\n";
+        if (tb_pieces)
+            std::cout << "tbhits: " << best->tb_hits << "\n";
+        std::cout << "stats: " << statsJson() << "\n";
+#ifdef COUNT_ALLOCS
+        std::cout << "allocations: " << allocs << "\n";
+#endif
     }
 }
\ No newline at end of file
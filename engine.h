@@ -2,26 +2,159 @@
 #define ENGINE_H
 
 #include <string>
-#include <variant>
 #include <utility>
 #include <vector>
-#include <ctime>
+#include <chrono>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "board.h"
+#include "tt.h"
+#include "book.h"
+#include "syzygy.h"
+#include "pawns.h"
+#include "stats.h"
+
+/**
+ * Per-ply search state. Each thread has one for every ply, so getBest
+ * works without heap allocations.
+ */
+struct SearchStack {
+    Move pv[MAX_PLY];              // triangular PV: best variant from this ply on
+    int pv_length = 0;
+    Move killers[2] = {NO_MOVE, NO_MOVE}; // quiet moves that cut off at this ply
+    Move move = NO_MOVE;           // move being searched from this ply
+    int static_eval = 0;
+};
+
+/**
+ * State owned by one search thread: its own copy of the root position and
+ * the result of its deepest completed iteration.
+ */
+struct SearchThread {
+    int id;
+    Board bd;
+    int depth = 0; // deepest completed iteration
+    int score = 0;
+    std::vector<Move> pv; // reserved for MAX_PLY moves, filled without reallocating
+    Counter nodes;   // read by the main thread for info lines while this one searches
+    Counter tb_hits; // positions resolved by a tablebase probe
+    SearchStats stats;
+
+    SearchStack stack[MAX_PLY + 1];
+
+    // move ordering, cleared at the start of every search
+    int history[2][64][64];     // [side][from][to], gains on cutoffs, loses when passed over
+    Move countermoves[64][64];  // [from][to] of the previous move: quiet reply that cut off
+
+    PawnTable pawns; // kept between searches, pawn structures stay valid
+
+    SearchThread(int id, const Board &bd) : id(id), bd(bd)
+    {
+        pv.reserve(MAX_PLY);
+        clearOrdering();
+    }
+    void clearOrdering();
+};
+
+/**
+ * Limits of one search; whichever is hit first ends it. A zero field is
+ * not a limit. With no limit at all the search runs to MAX_PLY.
+ */
+struct SearchLimits {
+    int depth = 0;
+    int movetime = 0;  // ms for this move
+    int time = 0;      // ms left on the clock of the side to move
+    int inc = 0;       // ms added after each move
+    int movestogo = 0; // moves to the next time control, 0: sudden death
+    uint64_t nodes = 0; // nodes of the main thread
+};
+
+/**
+ * Selective parts of the search; each can be turned off with a flag
+ * (nopvs, nonull, nolmr, norfp, nofutility, noext) to measure what it gives.
+ */
+struct SearchFeatures {
+    bool pvs = true;              // zero-window search after the first move
+    bool null_move = true;
+    bool lmr = true;              // late move reductions
+    bool reverse_futility = true; // static eval far above beta near the leaves
+    bool futility = true;         // quiet moves that cannot reach alpha near the leaves
+    bool check_extension = true;
+};
 
 class Engine{
     private:
         Board bd;
-        unsigned int flags; // print clock, print moves
-        std::pair<int, std::vector<Move>> getBest(Board &bd, int depth, int alfa, int beta);
-        static std::string moveAndPrint(Board &bd, const Move &b_move);
+        unsigned int flags; // uci info, print clock, print moves
+        TranspositionTable tt;
+        SearchFeatures features;
+        Book book;
+        int tb_limit = 7;  // probe positions with at most this many pieces
+        int tb_pieces = 0; // tb_limit capped by the largest table loaded, 0: no tables
+
+        // Lazy SMP pool: threads[0] runs on the caller, the others are helpers
+        std::vector<SearchThread> threads;
+        std::vector<std::thread> helpers;
+        std::mutex pool_mutex;
+        std::condition_variable pool_cv;
+        std::condition_variable done_cv;
+        unsigned int search_id = 0;
+        int search_depth = 0;
+        int running = 0;
+        bool quit = false;
+        std::atomic<bool> stop{false};
+
+        // time management, only the main thread looks at the clock
+        SearchLimits limits;
+        std::chrono::steady_clock::time_point start_time;
+        std::chrono::steady_clock::time_point soft_deadline; // no new iteration past it
+        std::chrono::steady_clock::time_point hard_deadline; // abort the running iteration
+        bool timed = false;
+        std::chrono::steady_clock::time_point next_info; // next periodic UCI info line
+
+        void helperLoop(int id);
+        void stopHelpers();
+        void setDeadlines();
+        void checkTime(const SearchThread &th);
+        bool aborted(const SearchThread &th) const;
+        void printInfo(const SearchThread &th);
+        void printProgress(std::chrono::steady_clock::time_point now);
+        std::string statsJson() const;
+        void iterate(SearchThread &th, int max_depth);
+        int aspiration(SearchThread &th, int depth);
+        static void updateOrdering(SearchThread &th, Move move, const MoveList &tried, int depth, int ply);
+        int getBest(SearchThread &th, int depth, int ply, int alfa, int beta);
+        int quiesce(SearchThread &th, int ply, int alpha, int beta);
+        static std::string moveAndPrint(Board &bd, Move b_move);
         static void printMoves(Board bd, const std::vector<Move> &b_moves);
-        static void printResult(Board bd, int val, const Move &b_move);
+        static void printResult(Board bd, int val, Move b_move);
         static void printResult(Board bd, int val, const std::vector<Move> &b_moves);
     public:
         Engine(std::string fen);
         Engine(std::string fen, std::vector<std::string> flags);
+        ~Engine();
+        void setThreads(int count);
+        bool setHash(size_t mb);
+        void clearHash();
+        bool setBook(const std::string &path);
+        void setBookBest(bool best);
+        Move bookMove();
+        bool setSyzygy(const std::string &path);
+        void setSyzygyLimit(int pieces);
+        Move tablebaseMove(TablebaseResult &result, int &dtz);
+        void setPosition(const Board &position);
+        void startSearch(const SearchLimits &search_limits);
+        const SearchThread &finishSearch();
+        void stopSearch();
+        uint64_t totalNodes() const;
         void findBestVariant(int depth);
+        void findBestVariant(const SearchLimits &search_limits);
+        static bool isMateScore(int score);
+        static int mateMoves(int score);
+        static void send(const std::string &text);
 };
 
-#endif //ENGINE_H
\ No newline at end of file
+#endif //ENGINE_H
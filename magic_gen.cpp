@@ -0,0 +1,104 @@
+#include "bitboard.h"
+#include <cstdio>
+
+/*
+ * Generator of magics.h: searches a magic multiplier for every square that
+ * maps all occupancy subsets of the relevant mask into a table of
+ * 2^(mask bits) entries without a destructive collision.
+ *
+ *   make magics
+ *
+ * The search is seeded, so its output only changes when the seeds or the
+ * generator do.
+ */
+
+/**
+ * @brief xorshift64* generator used for the magic search
+ */
+class MagicRng {
+private:
+    uint64_t s;
+
+public:
+    MagicRng(uint64_t seed) : s(seed) {}
+    uint64_t next()
+    {
+        s ^= s >> 12;
+        s ^= s << 25;
+        s ^= s >> 27;
+        return s * 2685821657736338717ULL;
+    }
+    // few bits set: good magic candidates
+    uint64_t sparse() { return next() & next() & next(); }
+};
+
+// per-rank seeds that find all magics of the rank after few candidates
+static const uint64_t MAGIC_SEEDS[8] = {1611, 275, 1848, 111, 1673, 442, 75, 263};
+
+static Bitboard findMagic(int sq, Bitboard (*attacks)(Bitboard, Bitboard))
+{
+    static Bitboard occupancy[4096], reference[4096], used[4096];
+    static int epoch[4096], current = 0;
+
+    Bitboard mask = relevantMask(sq, attacks);
+    unsigned shift = 64 - popCount(mask);
+
+    // enumerate every subset of the mask (carry-rippler)
+    int size = 0;
+    Bitboard b = 0;
+    do
+    {
+        occupancy[size] = b;
+        reference[size] = attacks(squareBB(sq), b);
+        size++;
+        b = (b - mask) & mask;
+    } while (b);
+
+    MagicRng rng(MAGIC_SEEDS[sq >> 3] * 0x9E3779B97F4A7C15ULL);
+    // try random magics until one maps all subsets without a destructive collision
+    Bitboard magic = 0;
+    for (int i = 0; i < size;)
+    {
+        do
+        {
+            magic = rng.sparse();
+        } while (popCount((mask * magic) >> 56) < 6);
+
+        current++;
+        for (i = 0; i < size; i++)
+        {
+            unsigned idx = unsigned(((occupancy[i] & mask) * magic) >> shift);
+            if (epoch[idx] < current)
+            {
+                epoch[idx] = current;
+                used[idx] = reference[i];
+            }
+            else if (used[idx] != reference[i])
+                break;
+        }
+    }
+    return magic;
+}
+
+static void printTable(const char *name, Bitboard (*attacks)(Bitboard, Bitboard))
+{
+    std::printf("constexpr Bitboard %s[64] = {\n", name);
+    for (int sq = 0; sq < 64; sq++)
+    {
+        std::printf("%s0x%016llXULL%s", sq % 4 == 0 ? "    " : " ",
+                    static_cast<unsigned long long>(findMagic(sq, attacks)),
+                    sq == 63 ? "\n" : sq % 4 == 3 ? ",\n" : ",");
+    }
+    std::printf("};\n");
+}
+
+int main()
+{
+    std::printf("#ifndef MAGICS_H\n#define MAGICS_H\n\n#include \"bitboard.h\"\n\n");
+    std::printf("/*\n * Slider magic multipliers by square, written by magic_gen (make magics).\n */\n\n");
+    printTable("BISHOP_MAGIC_NUMBERS", bishopAttacksBB);
+    std::printf("\n");
+    printTable("ROOK_MAGIC_NUMBERS", rookAttacksBB);
+    std::printf("\n#endif // MAGICS_H\n");
+    return 0;
+}
@@ -0,0 +1,48 @@
+#ifndef MAGICS_H
+#define MAGICS_H
+
+#include "bitboard.h"
+
+/*
+ * Slider magic multipliers by square, written by magic_gen (make magics).
+ */
+
+constexpr Bitboard BISHOP_MAGIC_NUMBERS[64] = {
+    0x2020211001304180ULL, 0x0420010101090040ULL, 0x46260C0112000918ULL, 0x9004104200400034ULL,
+    0x0001104040010824ULL, 0x8201042104000200ULL, 0x00040A2864040000ULL, 0x0CA1040A82081205ULL,
+    0x8000402401220210ULL, 0xC084081000B09100ULL, 0x0040504400444000ULL, 0x6400640502040290ULL,
+    0x0000211040110008ULL, 0x6009009010088000ULL, 0x0404420084844008ULL, 0x080011404208A081ULL,
+    0x0010804142080144ULL, 0xA008821002108400ULL, 0x0110020104008413ULL, 0x0108100082044004ULL,
+    0x001C00020094000CULL, 0x0312002105088202ULL, 0x8000410321282000ULL, 0x1012000020A40400ULL,
+    0x2CA00800202204A0ULL, 0x0002028A10440804ULL, 0x0228010008120021ULL, 0xA001004104040002ULL,
+    0x805D040002002101ULL, 0x1600820003080620ULL, 0x010E040400442270ULL, 0x8810808002160080ULL,
+    0x0082084000210200ULL, 0xC04A011000045044ULL, 0x0005844100100407ULL, 0x0208400809008200ULL,
+    0x01140404000C1100ULL, 0x0E18010102180880ULL, 0x0D010821004A0100ULL, 0x4208021020165100ULL,
+    0x0004048484014000ULL, 0xC000411028461000ULL, 0x8140402410014902ULL, 0x4002002011022800ULL,
+    0x0000080101021010ULL, 0x0010200090200100ULL, 0x0023040802080080ULL, 0x8010010051088080ULL,
+    0x0032014108404010ULL, 0x0053820090046020ULL, 0x4050008401210040ULL, 0x2039110084044400ULL,
+    0x08020040882880B0ULL, 0x0090040448420470ULL, 0x0040A80A84024082ULL, 0x1402020811010006ULL,
+    0x2080120890041040ULL, 0x050009009084A000ULL, 0x000890192A091010ULL, 0x0002200000420200ULL,
+    0x830A001810202200ULL, 0x200800C002040109ULL, 0x0001102002040046ULL, 0x4022063002008309ULL
+};
+
+constexpr Bitboard ROOK_MAGIC_NUMBERS[64] = {
+    0x0B00148000204100ULL, 0x0040001000200040ULL, 0x20800A1000822001ULL, 0x2080041000800800ULL,
+    0x0200040820100200ULL, 0x1600210200100804ULL, 0x2600280400820031ULL, 0x0100020080402100ULL,
+    0x0002002042008100ULL, 0x0002002042008100ULL, 0x0082001200802041ULL, 0x0804808010000800ULL,
+    0x0041000800118500ULL, 0x8484801200801400ULL, 0x140C000401084210ULL, 0x8018801100004880ULL,
+    0x2400420022010081ULL, 0x0012020042802302ULL, 0x0220008010002080ULL, 0x0001010020081004ULL,
+    0x1020050008010010ULL, 0xA044008080040200ULL, 0x0040040010010208ULL, 0x0000060001084084ULL,
+    0x5E80004140002002ULL, 0x0840084880200080ULL, 0x1000200080801000ULL, 0x0050008180108800ULL,
+    0x4020080080800400ULL, 0x0002040080020080ULL, 0x0290810400880210ULL, 0x0000208200104411ULL,
+    0x00512C4003800082ULL, 0x4002002082004101ULL, 0x8062200082801001ULL, 0x8208001000800880ULL,
+    0x0128000811000501ULL, 0x0082000401010008ULL, 0x2000020104000810ULL, 0x000220AC0A000341ULL,
+    0x4C80204000808001ULL, 0x2220002050024000ULL, 0x0020001008004040ULL, 0x0010008100080800ULL,
+    0x0000080004008080ULL, 0x4000402004080110ULL, 0x0410020001008080ULL, 0x018C108041120004ULL,
+    0x000B810150220200ULL, 0x8140042010004640ULL, 0x0000801001200480ULL, 0x0001001000082100ULL,
+    0x0014008114180180ULL, 0x3402001084E88200ULL, 0x8401000402000100ULL, 0x4000004104288200ULL,
+    0x008302800C104021ULL, 0x0000400020188501ULL, 0x8000084020120082ULL, 0x0140210004100109ULL,
+    0x0411008800021005ULL, 0x0011000208040001ULL, 0x0008101208884104ULL, 0x008008A304840042ULL
+};
+
+#endif // MAGICS_H
@@ -1,4 +1,16 @@
 #include "engine.h"
+#include "perft.h"
+#include "uci.h"
+#include "batch.h"
+#include "nnue.h"
+#include "pawns.h"
+#include "positions.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
 
 int readInt()
 {
@@ -7,20 +19,299 @@ int readInt()
     return stoi(tmp);
 }
 
+/**
+ * @brief perft subcommand
+ * perft <depth> [fen]: divide by root move
+ * perft suite <file.epd> [max depth]: check every known count in the file
+ * perfthash=<MB> anywhere on the line caches subtree counts
+ */
+int runPerft(const std::vector<std::string> &args)
+{
+    size_t hash_mb = 0;
+    std::vector<std::string> params;
+    for (size_t i = 2; i < args.size(); i++)
+    {
+        if (args[i].rfind("perfthash=", 0) == 0)
+            hash_mb = std::stoul(args[i].substr(10));
+        else if (args[i] != "noclock" && args[i] != "noprint")
+            params.push_back(args[i]);
+    }
+    if (params.empty())
+    {
+        std::cout << "usage: perft <depth> [fen] | perft suite <file.epd> [max depth]\n";
+        return 1;
+    }
+
+    Perft perft(hash_mb);
+    if (params[0] == "suite")
+    {
+        std::string path = params.size() > 1 ? params[1] : "perft.epd";
+        int max_depth = params.size() > 2 ? std::stoi(params[2]) : 99;
+        return perft.suite(path, max_depth) ? 0 : 1;
+    }
+
+    std::string fen;
+    for (size_t i = 1; i < params.size(); i++)
+        fen += params[i] + " ";
+    Board bd(fen);
+    perft.divide(bd, std::stoi(params[0]));
+    return 0;
+}
+
+/**
+ * @brief polyglot subcommand: polyglot [file.epd] checks the Polyglot key
+ * of every position in the file against the key given after ";key"
+ */
+int runPolyglot(const std::vector<std::string> &args)
+{
+    std::string path = args.size() > 2 ? args[2] : "polyglot.epd";
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cout << "cannot open " << path << "\n";
+        return 1;
+    }
+
+    int passed = 0, failed = 0;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        size_t sep = line.find(';');
+        if (line.empty() || line[0] == '#' || sep == std::string::npos)
+            continue;
+
+        std::istringstream entry(line.substr(sep + 1));
+        std::string name;
+        uint64_t expected;
+        if (!(entry >> name >> std::hex >> expected) || name != "key")
+            continue;
+        Board bd(line.substr(0, sep));
+        uint64_t key = Book::key(bd);
+        if (key == expected)
+            passed++;
+        else
+        {
+            failed++;
+            std::cout << "FAIL " << line.substr(0, sep) << ": " << std::hex << key << " expected " << expected
+                      << std::dec << "\n";
+        }
+    }
+    std::cout << "passed: " << passed << ", failed: " << failed << "\n";
+    return failed == 0 ? 0 : 1;
+}
+
+/**
+ * @brief evalbench subcommand: evaluations per second of the classic
+ * evaluation (with a pawn hash) and of the network, over every legal move of a few positions,
+ * alone and together with the make/undo that keeps the accumulator current.
+ * Without nnue=<file> the network has random weights, which is as fast.
+ */
+int runEvalBench(const std::vector<std::string> &args)
+{
+    const int ROUNDS = 20000;
+
+    auto run = [&](const char *name) {
+        std::vector<Board> boards;
+        PawnTable pawns;
+        for (const char *fen : SAMPLE_FENS)
+            boards.emplace_back(fen);
+        long long checksum = 0, evals = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < ROUNDS; r++)
+        {
+            for (Board &bd : boards)
+            {
+                checksum += bd.eval(pawns);
+                evals++;
+            }
+        }
+        double eval_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        long long updates = 0;
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < ROUNDS / 20; r++)
+        {
+            for (Board &bd : boards)
+            {
+                MoveList moves;
+                bd.allMoves(moves);
+                for (Move move : moves)
+                {
+                    bd.movePiece(move);
+                    checksum += bd.eval(pawns);
+                    bd.undoMove();
+                    updates++;
+                }
+            }
+        }
+        double update_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << evals / eval_s / 1e6 << " M evals/s, "
+                  << update_s / updates * 1e9 << " ns per make+eval+undo (checksum " << checksum << ")\n";
+    };
+
+    run("classic");
+    std::string path;
+    for (const auto &arg : args)
+    {
+        if (arg.rfind("nnue=", 0) == 0)
+            path = arg.substr(5);
+    }
+    if (path.empty())
+        NNUE.randomize(1);
+    else if (!NNUE.load(path))
+    {
+        std::cerr << "cannot load network " << path << "\n";
+        return 1;
+    }
+    run("network");
+    return 0;
+}
+
+/**
+ * @brief bench subcommand: fixed-depth search of a built-in position set.
+ * bench [depth] [threads]; with one thread the node total is reproducible
+ * and changes only when the search does, so it doubles as a signature.
+ * The hash is cleared before each position; hash=<MB> and nnue=<file> apply.
+ */
+int runBench(const std::vector<std::string> &args)
+{
+    static const char *FENS[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+        "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+        "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+        "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+        "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+        "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+        "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+        "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+        "2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+        "r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+        "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+        "r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+        "4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+        "3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+        "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/3N4 b - - 0 1",
+        "3b4/5kp1/1p1p1p1p/pP1PpP1P/P1P1P3/3KN3/8/8 w - - 0 1",
+        "2K5/p7/7P/5pR1/8/5k2/r7/8 w - - 0 1",
+        "8/6pk/1p6/8/PP3p1p/5P2/4KP1q/3Q4 w - - 0 1",
+        "7k/3p2pp/4q3/8/4Q3/5Kp1/P6b/8 w - - 0 1",
+        "8/2p5/8/2kPKp1p/2p4P/2P5/3P4/8 w - - 0 1",
+        "8/1p3pp1/7p/5P1P/2k3P1/8/2K2P2/8 w - - 0 1",
+        "8/pp2r1k1/2p1p3/3pP2p/1P1P1P1P/P5KR/8/8 w - - 0 1",
+        "8/3p4/p1bk3p/Pp6/1Kp1PpPp/2P2P1P/2P5/5B2 b - - 0 1",
+        "5k2/7R/4P2p/5K2/p1r2P1p/8/8/8 b - - 0 1",
+        "6k1/6p1/P6p/r1N5/5p2/7P/1b3PP1/4R1K1 w - - 0 1",
+        "1r3k2/4q3/2Pp3b/3Bp3/2Q2p2/1p1P2P1/1P2KP2/3N4 w - - 0 1",
+        "6k1/4pp1p/3p2p1/P1pPb3/R7/1r2P1PP/3B1P2/6K1 w - - 0 1",
+        "8/3p3B/5p2/5P2/p7/PP5b/k7/6K1 w - - 0 1",
+        "5rk1/q6p/2p3bR/1pPp1rP1/1P1Pp3/P3B1Q1/1K3P2/R7 w - - 93 90",
+        "4rrk1/1p1nq3/p7/2p1P1pp/3P2bp/3Q1Bn1/PPPB4/1K2R1NR w - - 40 21",
+        "r3k2r/3nnpbp/q2pp1p1/p7/Pp1PPPP1/4BNN1/1P5P/R2Q1RK1 w kq - 0 16",
+        "3Qb1k1/1r2ppb1/pN1n2q1/Pp1Pp1Pr/4P2p/4BP2/4B1R1/1R5K b - - 11 40",
+        "4k3/3q1r2/1N2r1b1/3ppN2/2nPP3/1B1R2n1/2R1Q3/3K4 w - - 5 1",
+        "8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+        "8/8/1P6/5pr1/8/4R3/7k/2K5 w - - 0 1",
+        "8/R7/2q5/8/6k1/8/1P5p/K6R w - - 0 124",
+        "6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1", // mate in 5
+        "2bB4/N2k1N2/3P1P2/4p3/1R3p1P/Q6p/6p1/K3R3 w - - 0 1",          // mate in 3
+    };
+    const int count = sizeof(FENS) / sizeof(FENS[0]);
+
+    SearchLimits limits;
+    limits.depth = args.size() > 2 && std::isdigit(args[2][0]) ? std::stoi(args[2]) : 8;
+    int threads = args.size() > 3 && std::isdigit(args[3][0]) ? std::stoi(args[3]) : 1;
+
+    std::vector<std::string> flags = args;
+    flags.push_back("noprint");
+    flags.push_back("noclock");
+    Engine engine(FENS[0], flags);
+    engine.setThreads(std::max(1, threads));
+
+    uint64_t nodes = 0;
+    double elapsed = 0;
+    for (int i = 0; i < count; i++)
+    {
+        engine.setPosition(Board(FENS[i]));
+        engine.clearHash();
+        auto start = std::chrono::steady_clock::now();
+        engine.startSearch(limits);
+        const SearchThread &best = engine.finishSearch();
+        elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        uint64_t position_nodes = engine.totalNodes();
+        nodes += position_nodes;
+        std::cout << "position " << i + 1 << "/" << count << ": " << position_nodes << " nodes, best "
+                  << (best.pv.empty() ? "none" : Board::descMove(best.pv[0])) << "\n";
+    }
+    std::cout << "depth: " << limits.depth << ", threads: " << std::max(1, threads) << "\n";
+    std::cout << "nodes: " << nodes << "\n";
+    std::cout << "time : " << elapsed << " s" << "\n";
+    std::cout << "nps  : " << uint64_t(nodes / std::max(elapsed, 1e-9)) << "\n";
+    return 0;
+}
+
 int main(int argc, char* argv[])
 {
     char** begin = argv;
-    char** end = argv + argc; 
+    char** end = argv + argc;
     std::vector<std::string> args_vector(begin, end);
 
+    // on stderr: stdout of the subcommands carries only their results;
+    // a UCI session prints nothing outside the protocol
+    double init_time = initAttacks();
+    bool uci_mode = args_vector.size() > 1 && args_vector[1] == "uci";
+    if (!uci_mode && std::find(args_vector.begin(), args_vector.end(), "noclock") == args_vector.end())
+        std::cerr << "attack tables: " << init_time * 1000 << " ms" << "\n";
+
+    if (args_vector.size() > 1 && args_vector[1] == "evalbench")
+        return runEvalBench(args_vector);
+    for (const auto &arg : args_vector)
+    {
+        // before any Board exists, so that every accumulator starts from this network
+        if (arg.rfind("nnue=", 0) == 0 && !NNUE.load(arg.substr(5)))
+            std::cerr << "cannot load network " << arg.substr(5) << ", using the classic evaluation\n";
+    }
+
+    if (args_vector.size() > 1 && args_vector[1] == "perft")
+        return runPerft(args_vector);
+    if (args_vector.size() > 1 && args_vector[1] == "bench")
+        return runBench(args_vector);
+    if (args_vector.size() > 1 && args_vector[1] == "polyglot")
+        return runPolyglot(args_vector);
+    if (args_vector.size() > 2 && args_vector[1] == "batch")
+    {
+        std::vector<std::string> options(args_vector.begin() + 3, args_vector.end());
+        return Batch(options).run(args_vector[2]);
+    }
+    if (uci_mode)
+    {
+        Uci uci(args_vector);
+        uci.loop(std::cin);
+        return 0;
+    }
+
     // 6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1 //mate in 5
     // 2bB4/N2k1N2/3P1P2/4p3/1R3p1P/Q6p/6p1/K3R3 w - - 0 1 //mate in 3
+    // prompts only for a person at a terminal: a GUI that starts the engine
+    // without arguments pipes "uci" in and must see nothing before its reply
+    bool interactive = isatty(STDIN_FILENO);
     std::string fen;
-    std::cout << "Enter FEN: ";
+    if (interactive)
+        std::cout << "Enter FEN: " << std::flush;
     std::getline(std::cin, fen);
-    std::cout << "Enter depth: ";
+    if (fen == "uci")
+    {
+        // a GUI started us without arguments, stay in UCI mode
+        Uci uci(args_vector);
+        uci.command(fen);
+        uci.loop(std::cin);
+        return 0;
+    }
+    if (interactive)
+        std::cout << "Enter depth: " << std::flush;
     int depth = readInt();
     Engine engine(fen, args_vector);
     engine.findBestVariant(depth);
     return 0;
-}
\ No newline at end of file
+}
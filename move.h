@@ -0,0 +1,61 @@
+#ifndef MOVE_H
+#define MOVE_H
+
+#include <cstdint>
+#include "bitboard.h"
+
+/*
+ * A move packed in 16 bits: from square | to square << 6 | flag << 12
+ * squares use the Board layout (y*8 + x)
+ */
+typedef uint16_t Move;
+
+enum MoveFlag {
+    NORMAL = 0,
+    ENPASS = 1,
+    CASTLE = 2,
+    PROMOTION = 4 // 4..7: promotion to knight, bishop, rook, queen
+};
+
+constexpr Move NO_MOVE = 0; // A8 -> A8, never a real move
+
+constexpr Move makeMove(int from, int to, int flag = NORMAL)
+{
+    return Move(from | to << 6 | flag << 12);
+}
+
+constexpr Move makePromotion(int from, int to, Piece piece)
+{
+    return makeMove(from, to, PROMOTION + piece - KNIGHT);
+}
+
+constexpr int moveFrom(Move move) { return move & 63; }
+constexpr int moveTo(Move move) { return (move >> 6) & 63; }
+constexpr int moveFlag(Move move) { return move >> 12; }
+constexpr bool isPromotion(Move move) { return move >> 14; }
+constexpr Piece promotionPiece(Move move) { return Piece(KNIGHT + ((move >> 12) & 3)); }
+
+/**
+ * Fixed-capacity move list living on the stack; generators append to it.
+ * 256 is above the largest number of pseudo-legal moves in any position.
+ */
+struct MoveList {
+    static constexpr int CAPACITY = 256;
+
+    Move moves[CAPACITY];
+    int count = 0;
+
+    void add(Move move) { moves[count++] = move; }
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    Move &operator[](int i) { return moves[i]; }
+    Move operator[](int i) const { return moves[i]; }
+    Move *begin() { return moves; }
+    Move *end() { return moves + count; }
+    const Move *begin() const { return moves; }
+    const Move *end() const { return moves + count; }
+};
+
+#endif // MOVE_H
@@ -0,0 +1,191 @@
+#include "movepick.h"
+#include "engine.h"
+#include "psqt.h"
+#include <algorithm>
+
+// move ordering tiers, a higher score is searched earlier
+static constexpr int ORDER_CAPTURE = 1 << 24; // + MVV-LVA
+static constexpr int ORDER_KILLER = 1 << 20;  // + 1 for the newer slot
+static constexpr int ORDER_COUNTER = ORDER_KILLER - 1;
+static constexpr int ORDER_UNDERPROMOTION = -2 * MAX_HISTORY; // below every quiet move
+static constexpr int ORDER_BAD_CAPTURE = -4 * MAX_HISTORY;    // + MVV-LVA, captures losing material
+
+MovePicker::MovePicker(SearchThread &th, int ply, Move tt_move, bool in_check, bool quiets)
+    : th(th), bd(th.bd), tt_move(tt_move), in_check(in_check), quiets(quiets)
+{
+    Move prev = bd.lastMove();
+    specials[0] = th.stack[ply].killers[0];
+    specials[1] = th.stack[ply].killers[1];
+    specials[2] = prev ? th.countermoves[moveFrom(prev)][moveTo(prev)] : NO_MOVE;
+}
+
+/**
+ * @brief ordering score: captures and queen promotions by MVV-LVA, those
+ * losing material by SEE after every quiet move; killers, the countermove,
+ * then quiets by history
+ */
+int MovePicker::score(Move move)
+{
+    int from = moveFrom(move), to = moveTo(move);
+    Piece victim = moveFlag(move) == ENPASS ? PAWN : bd.pieceOn(to);
+    if (victim != NO_PIECE || (isPromotion(move) && promotionPiece(move) == QUEEN))
+    {
+        int gain = victim != NO_PIECE ? victim * 8 : 0;
+        if (isPromotion(move) && promotionPiece(move) == QUEEN)
+            gain += QUEEN * 8;
+        Piece attacker = bd.pieceOn(from);
+        // only a capture of a cheaper piece can lose material
+        bool losing = victim != NO_PIECE && PIECE_VALUES[victim] < PIECE_VALUES[attacker] && bd.see(move) < 0;
+        return (losing ? ORDER_BAD_CAPTURE : ORDER_CAPTURE) + gain - attacker;
+    }
+    if (move == specials[0])
+        return ORDER_KILLER + 1;
+    if (move == specials[1])
+        return ORDER_KILLER;
+    if (move == specials[2])
+        return ORDER_COUNTER;
+    if (isPromotion(move))
+        return ORDER_UNDERPROMOTION;
+    return th.history[bd.onMove()][from][to];
+}
+
+/**
+ * @brief score moves[begin, end) and sort them, best first; insertion sort
+ * keeps equal moves in generation order and lists are short
+ */
+void MovePicker::scoreAndSort(int begin, int end)
+{
+    for (int i = begin; i < end; i++)
+    {
+        Move move = moves[i];
+        int value = score(move);
+        int j = i - 1;
+        for (; j >= begin && scores[j] < value; j--)
+        {
+            scores[j + 1] = scores[j];
+            moves[j + 1] = moves[j];
+        }
+        scores[j + 1] = value;
+        moves[j + 1] = move;
+    }
+}
+
+/**
+ * @return the next move to search, NO_MOVE when there are no more
+ */
+Move MovePicker::next()
+{
+    switch (stage)
+    {
+    case TT_MOVE:
+        stage = GEN_CAPTURES;
+        if (tt_move != NO_MOVE && bd.isLegal(tt_move))
+            return tt_move;
+        [[fallthrough]];
+
+    case GEN_CAPTURES:
+        bd.captureMoves(moves); // every evasion when in check
+        capture_end = end = moves.size();
+        scoreAndSort(0, end);
+        if (in_check)
+        {
+            stage = EVASIONS;
+            return next();
+        }
+        good_end = 0;
+        while (good_end < capture_end && scores[good_end] > ORDER_KILLER)
+            good_end++;
+        stage = GOOD_CAPTURES;
+        [[fallthrough]];
+
+    case GOOD_CAPTURES:
+        while (current < good_end)
+        {
+            Move move = moves[current++];
+            if (move != tt_move)
+                return move;
+        }
+        stage = quiets ? KILLERS : BAD_CAPTURES;
+        return next();
+
+    case KILLERS:
+        while (special < 3)
+        {
+            Move move = specials[special++];
+            if (move == NO_MOVE || move == tt_move || std::count(specials, specials + special, move) > 1)
+                continue;
+            // a killer that became a capture came with the captures
+            if (bd.pieceOn(moveTo(move)) != NO_PIECE || moveFlag(move) == ENPASS || isPromotion(move))
+                continue;
+            if (bd.isLegal(move))
+                return move;
+        }
+        stage = GEN_QUIETS;
+        [[fallthrough]];
+
+    case GEN_QUIETS:
+        bd.quietMoves(moves);
+        end = moves.size();
+        scoreAndSort(capture_end, end);
+        current = capture_end;
+        stage = QUIETS;
+        [[fallthrough]];
+
+    case QUIETS:
+        while (current < end)
+        {
+            Move move = moves[current++];
+            if (move != tt_move && move != specials[0] && move != specials[1] && move != specials[2])
+                return move;
+        }
+        current = good_end;
+        stage = BAD_CAPTURES;
+        [[fallthrough]];
+
+    case BAD_CAPTURES:
+        while (current < capture_end)
+        {
+            Move move = moves[current++];
+            if (move != tt_move)
+                return move;
+        }
+        stage = DONE;
+        return NO_MOVE;
+
+    case EVASIONS:
+        while (current < end)
+        {
+            Move move = moves[current++];
+            if (move != tt_move)
+                return move;
+        }
+        stage = DONE;
+        return NO_MOVE;
+
+    case REPLAY:
+        if (current < end)
+            return moves[current++];
+        stage = DONE;
+        return NO_MOVE;
+
+    default:
+        return NO_MOVE;
+    }
+}
+
+/**
+ * @brief generate every move at once and rotate the order by shift, so
+ * that helper threads start the first plies on different moves
+ */
+void MovePicker::rotate(int shift)
+{
+    MoveList all;
+    for (Move move = next(); move != NO_MOVE; move = next())
+        all.add(move);
+    moves = all;
+    current = 0;
+    end = moves.size();
+    if (end > 0)
+        std::rotate(moves.begin(), moves.begin() + shift % end, moves.begin() + end);
+    stage = REPLAY;
+}
@@ -0,0 +1,61 @@
+#ifndef MOVEPICK_H
+#define MOVEPICK_H
+
+#include "board.h"
+
+struct SearchThread;
+
+constexpr int MAX_HISTORY = 1 << 14; // history stays in [-MAX_HISTORY, MAX_HISTORY]
+
+/**
+ * Hands out the moves of a node one at a time, generating them in stages:
+ * the hash move (checked for legality alone), captures and queen promotions
+ * that do not lose material, killers and the countermove, the other quiet
+ * moves by history, and last losing captures and underpromotions. A node
+ * that cuts off early never generates its quiet moves.
+ *
+ * In check every evasion comes in one sorted stage. Quiescence pickers
+ * leave out the quiet stages.
+ */
+class MovePicker {
+private:
+    enum Stage {
+        TT_MOVE,
+        GEN_CAPTURES,
+        GOOD_CAPTURES,
+        KILLERS,
+        GEN_QUIETS,
+        QUIETS,
+        BAD_CAPTURES,
+        EVASIONS,
+        REPLAY,
+        DONE
+    };
+
+    SearchThread &th;
+    Board &bd;
+    Stage stage = TT_MOVE;
+    Move tt_move;
+    Move specials[3]; // killers and countermove, the stage after the good captures
+    int special = 0;  // specials tried
+    bool in_check;
+    bool quiets;      // false in quiescence
+
+    MoveList moves;   // captures [0, capture_end), good ones first; quiets after them
+    int scores[MoveList::CAPACITY];
+    int current = 0;
+    int end = 0;
+    int good_end = 0;    // end of the good captures
+    int capture_end = 0;
+
+    int score(Move move);
+    void scoreAndSort(int begin, int end);
+
+public:
+    MovePicker(SearchThread &th, int ply, Move tt_move, bool in_check, bool quiets = true);
+
+    Move next();
+    void rotate(int shift);
+};
+
+#endif // MOVEPICK_H
@@ -0,0 +1,196 @@
+#include "nnue.h"
+#include <fstream>
+#include <memory>
+#include <random>
+
+#if !defined(NNUE_SCALAR) && defined(__AVX2__)
+#include <immintrin.h>
+#define NNUE_AVX2
+#elif !defined(NNUE_SCALAR) && defined(__SSE2__)
+#include <emmintrin.h>
+#define NNUE_SSE2
+#endif
+
+Network NNUE;
+
+/**
+ * @brief input index of a piece from one side's point of view: own pieces
+ * first, squares from that side's first rank (a1 = 0 for white)
+ */
+int Network::feature(int sq, Piece piece, bool white, bool perspective)
+{
+    int relative_sq = perspective ? sq ^ 56 : sq;
+    return (white == perspective ? 0 : 384) + piece * 64 + relative_sq;
+}
+
+/**
+ * @brief read a network: little-endian int16 feature weights [768][256],
+ * feature bias [256], output weights [2][256] (side on move first) and the
+ * output bias, with trailing padding allowed
+ * @return false if the file is missing or too short; the previous network stays
+ */
+bool Network::load(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    // read into a copy so that a short file cannot leave half a network behind
+    auto next = std::make_unique<Network>();
+    file.read(reinterpret_cast<char *>(next->feature_weights), sizeof(next->feature_weights));
+    file.read(reinterpret_cast<char *>(next->feature_bias), sizeof(next->feature_bias));
+    file.read(reinterpret_cast<char *>(next->output_weights), sizeof(next->output_weights));
+    file.read(reinterpret_cast<char *>(&next->output_bias), sizeof(next->output_bias));
+    if (!file)
+        return false;
+    next->loaded = true;
+    *this = *next;
+    return true;
+}
+
+/**
+ * @brief small random weights: for measuring speed without a trained network
+ */
+void Network::randomize(uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> weight(-64, 64);
+    for (auto &column : feature_weights)
+    {
+        for (int16_t &w : column)
+            w = weight(rng);
+    }
+    for (int16_t &b : feature_bias)
+        b = weight(rng);
+    for (auto &side : output_weights)
+    {
+        for (int16_t &w : side)
+            w = weight(rng);
+    }
+    output_bias = weight(rng);
+    loaded = true;
+}
+
+void Network::reset(Accumulator &acc) const
+{
+    for (int p = BLACK; p <= WHITE; p++)
+    {
+        for (int i = 0; i < NNUE_HIDDEN; i++)
+            acc.values[p][i] = feature_bias[i];
+    }
+}
+
+/**
+ * @brief values += added - removed over one perspective's hidden layer;
+ * a null column is left out at compile time
+ */
+template <bool ADD, bool SUB>
+static void updateColumns(int16_t *values, const int16_t *added, const int16_t *removed)
+{
+#if defined(NNUE_AVX2)
+    for (int i = 0; i < NNUE_HIDDEN; i += 16)
+    {
+        __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i *>(values + i));
+        if constexpr (ADD)
+            v = _mm256_add_epi16(v, _mm256_load_si256(reinterpret_cast<const __m256i *>(added + i)));
+        if constexpr (SUB)
+            v = _mm256_sub_epi16(v, _mm256_load_si256(reinterpret_cast<const __m256i *>(removed + i)));
+        _mm256_store_si256(reinterpret_cast<__m256i *>(values + i), v);
+    }
+#elif defined(NNUE_SSE2)
+    for (int i = 0; i < NNUE_HIDDEN; i += 8)
+    {
+        __m128i v = _mm_load_si128(reinterpret_cast<const __m128i *>(values + i));
+        if constexpr (ADD)
+            v = _mm_add_epi16(v, _mm_load_si128(reinterpret_cast<const __m128i *>(added + i)));
+        if constexpr (SUB)
+            v = _mm_sub_epi16(v, _mm_load_si128(reinterpret_cast<const __m128i *>(removed + i)));
+        _mm_store_si128(reinterpret_cast<__m128i *>(values + i), v);
+    }
+#else
+    for (int i = 0; i < NNUE_HIDDEN; i++)
+    {
+        if constexpr (ADD)
+            values[i] += added[i];
+        if constexpr (SUB)
+            values[i] -= removed[i];
+    }
+#endif
+}
+
+void Network::add(Accumulator &acc, int sq, Piece piece, bool white) const
+{
+    for (int p = BLACK; p <= WHITE; p++)
+        updateColumns<true, false>(acc.values[p], feature_weights[feature(sq, piece, white, p)], nullptr);
+}
+
+void Network::sub(Accumulator &acc, int sq, Piece piece, bool white) const
+{
+    for (int p = BLACK; p <= WHITE; p++)
+        updateColumns<false, true>(acc.values[p], nullptr, feature_weights[feature(sq, piece, white, p)]);
+}
+
+/**
+ * @brief a piece going from one square to another, in one pass over the accumulator
+ */
+void Network::move(Accumulator &acc, int from, int to, Piece piece, bool white) const
+{
+    for (int p = BLACK; p <= WHITE; p++)
+        updateColumns<true, true>(acc.values[p], feature_weights[feature(to, piece, white, p)],
+                                  feature_weights[feature(from, piece, white, p)]);
+}
+
+/**
+ * @brief sum of clipped ReLU(accumulator) times the output weights of one
+ * perspective, in QA * QB units
+ */
+static int32_t outputLayer(const int16_t *values, const int16_t *weights)
+{
+#if defined(NNUE_AVX2)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i qa = _mm256_set1_epi16(NNUE_QA);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < NNUE_HIDDEN; i += 16)
+    {
+        __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i *>(values + i));
+        __m256i w = _mm256_load_si256(reinterpret_cast<const __m256i *>(weights + i));
+        v = _mm256_min_epi16(_mm256_max_epi16(v, zero), qa);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, w));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    return _mm_cvtsi128_si32(half);
+#elif defined(NNUE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i qa = _mm_set1_epi16(NNUE_QA);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < NNUE_HIDDEN; i += 8)
+    {
+        __m128i v = _mm_load_si128(reinterpret_cast<const __m128i *>(values + i));
+        __m128i w = _mm_load_si128(reinterpret_cast<const __m128i *>(weights + i));
+        v = _mm_min_epi16(_mm_max_epi16(v, zero), qa);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(v, w));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < NNUE_HIDDEN; i++)
+    {
+        int32_t v = values[i] < 0 ? 0 : values[i] > NNUE_QA ? NNUE_QA : values[i];
+        sum += v * weights[i];
+    }
+    return sum;
+#endif
+}
+
+/**
+ * @brief score in centipawns for the side on move
+ */
+int Network::evaluate(const Accumulator &acc, bool white) const
+{
+    int64_t sum = static_cast<int64_t>(outputLayer(acc.values[white], output_weights[0])) +
+                  outputLayer(acc.values[!white], output_weights[1]);
+    return static_cast<int>((sum + output_bias) * NNUE_SCALE / (NNUE_QA * NNUE_QB));
+}
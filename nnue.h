@@ -0,0 +1,54 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <cstdint>
+#include <string>
+#include "bitboard.h"
+
+/*
+ * Efficiently updatable network: 768 inputs (piece kind x square, seen from
+ * one side) -> 256 hidden units per perspective -> 1 output.
+ *
+ * The hidden layer of both perspectives is the accumulator, kept in the
+ * Board and changed by putPiece/removePiece/shiftPiece, so make and undo
+ * cost one to three column updates instead of a full first layer. Evaluation runs
+ * the clipped ReLU and the output layer over it: AVX2 if compiled with
+ * -mavx2, SSE2 on other x86-64 builds, plain loops elsewhere or with
+ * -DNNUE_SCALAR.
+ */
+
+constexpr int NNUE_INPUTS = 768;
+constexpr int NNUE_HIDDEN = 256;
+constexpr int NNUE_QA = 255;   // hidden activations are clipped to [0, QA]
+constexpr int NNUE_QB = 64;    // output weight quantization
+constexpr int NNUE_SCALE = 400; // network output to centipawns
+
+struct alignas(64) Accumulator {
+    int16_t values[2][NNUE_HIDDEN]; // indexed by the perspective's Color
+};
+
+class Network {
+private:
+    alignas(64) int16_t feature_weights[NNUE_INPUTS][NNUE_HIDDEN];
+    alignas(64) int16_t feature_bias[NNUE_HIDDEN];
+    alignas(64) int16_t output_weights[2][NNUE_HIDDEN]; // side on move, side not on move
+    int16_t output_bias = 0;
+    bool loaded = false;
+
+    static int feature(int sq, Piece piece, bool white, bool perspective);
+
+public:
+    bool load(const std::string &path);
+    void randomize(uint64_t seed);
+    bool isLoaded() const { return loaded; }
+
+    void reset(Accumulator &acc) const;
+    void add(Accumulator &acc, int sq, Piece piece, bool white) const;
+    void sub(Accumulator &acc, int sq, Piece piece, bool white) const;
+    void move(Accumulator &acc, int from, int to, Piece piece, bool white) const;
+    int evaluate(const Accumulator &acc, bool white) const;
+};
+
+extern Network NNUE;
+
+#endif // NNUE_H
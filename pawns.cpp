@@ -0,0 +1,144 @@
+#include "pawns.h"
+#include "stats.h"
+#include <array>
+
+// centipawns, middlegame / endgame
+static constexpr int DOUBLED_MG = -10, DOUBLED_EG = -20;   // per pawn in front of another one
+static constexpr int ISOLATED_MG = -10, ISOLATED_EG = -15;
+static constexpr int BACKWARD_MG = -8, BACKWARD_EG = -10;
+static constexpr int PASSED_MG[8] = {0, 5, 10, 20, 35, 60, 100, 0}; // by rank counted from the own side
+static constexpr int PASSED_EG[8] = {0, 10, 20, 35, 60, 100, 150, 0};
+static constexpr int SHELTER_MG = 12; // per own pawn in the two ranks in front of the king
+
+struct PawnMasks {
+    Bitboard adjacent[8];          // files next to a file
+    Bitboard front[2][64];         // [Color][sq]: same file, toward the promotion rank
+    Bitboard passed[2][64];        // front spans of the own and adjacent files
+    Bitboard support[2][64];       // adjacent files, same rank or behind
+    Bitboard shelter[2][64];       // [Color][king sq]: king file and neighbours, two ranks ahead
+};
+
+static const auto MASKS = [] {
+    PawnMasks masks{};
+    for (int x = 0; x < 8; x++)
+    {
+        if (x > 0)
+            masks.adjacent[x] |= FILE_A << (x - 1);
+        if (x < 7)
+            masks.adjacent[x] |= FILE_A << (x + 1);
+    }
+    for (int sq = 0; sq < 64; sq++)
+    {
+        int x = sq % 8, y = sq / 8;
+        Bitboard file = FILE_A << x;
+        Bitboard files = file | masks.adjacent[x];
+        for (int c = BLACK; c <= WHITE; c++)
+        {
+            // white pawns move toward y = 0
+            for (int row = 0; row < 8; row++)
+            {
+                bool ahead = c == WHITE ? row < y : row > y;
+                int distance = c == WHITE ? y - row : row - y;
+                if (ahead)
+                {
+                    masks.front[c][sq] |= file & rankBB(row);
+                    masks.passed[c][sq] |= files & rankBB(row);
+                }
+                else
+                    masks.support[c][sq] |= masks.adjacent[x] & rankBB(row);
+                if (ahead && distance <= 2)
+                    masks.shelter[c][sq] |= files & rankBB(row);
+            }
+        }
+    }
+    return masks;
+}();
+
+PawnTable::PawnTable(size_t count) : entries(count)
+{
+}
+
+/**
+ * @brief evaluate the pawn structure from scratch
+ */
+PawnEntry PawnTable::compute(Board &bd)
+{
+    PawnEntry entry;
+    entry.key = bd.pawnKey();
+    Bitboard pawns[2] = {bd.pieceSet(PAWN) & bd.colorSet(false), bd.pieceSet(PAWN) & bd.colorSet(true)};
+    entry.attacks[BLACK] = pawnAttacksBB(pawns[BLACK], false);
+    entry.attacks[WHITE] = pawnAttacksBB(pawns[WHITE], true);
+
+    for (int c = BLACK; c <= WHITE; c++)
+    {
+        int mg = 0, eg = 0;
+        Bitboard own = pawns[c], enemy = pawns[!c];
+        Bitboard set = own;
+        while (set)
+        {
+            int sq = popLsb(set);
+            int x = sq % 8;
+            int rank = c == WHITE ? 7 - sq / 8 : sq / 8;
+
+            if (MASKS.front[c][sq] & own)
+            {
+                mg += DOUBLED_MG;
+                eg += DOUBLED_EG;
+            }
+            if (!(MASKS.adjacent[x] & own))
+            {
+                mg += ISOLATED_MG;
+                eg += ISOLATED_EG;
+            }
+            else if (!(MASKS.support[c][sq] & own) &&
+                     (squareBB(c == WHITE ? sq - 8 : sq + 8) & entry.attacks[!c]))
+            {
+                mg += BACKWARD_MG;
+                eg += BACKWARD_EG;
+            }
+            if (!(MASKS.passed[c][sq] & enemy) && !(MASKS.front[c][sq] & own))
+            {
+                entry.passed |= squareBB(sq);
+                mg += PASSED_MG[rank];
+                eg += PASSED_EG[rank];
+            }
+        }
+        entry.mg += c == WHITE ? mg : -mg;
+        entry.eg += c == WHITE ? eg : -eg;
+    }
+    return entry;
+}
+
+/**
+ * @brief pawn structure of the position, from the table or computed and stored
+ */
+const PawnEntry &PawnTable::probe(Board &bd)
+{
+    uint64_t key = bd.pawnKey();
+    PawnEntry &entry = entries[key & (entries.size() - 1)];
+    STAT(probes++);
+    if (entry.key == key)
+    {
+        STAT(hits++);
+        return entry;
+    }
+    entry = compute(bd);
+    return entry;
+}
+
+void PawnTable::resetStats()
+{
+    probes = hits = 0;
+}
+
+/**
+ * @brief middlegame bonus for own pawns right in front of the king
+ */
+int kingShelter(Board &bd, bool white)
+{
+    int king = bd.kingSquare(white);
+    if (king < 0)
+        return 0;
+    Bitboard own = bd.pieceSet(PAWN) & bd.colorSet(white);
+    return SHELTER_MG * popCount(MASKS.shelter[white][king] & own);
+}
@@ -0,0 +1,41 @@
+#ifndef PAWNS_H
+#define PAWNS_H
+
+#include <vector>
+#include "board.h"
+
+/**
+ * Pawn structure of a position: everything here depends on the pawns of
+ * both sides and nothing else, so it is cached under Board::pawnKey.
+ */
+struct PawnEntry {
+    uint64_t key = 0; // the zero entry is the empty structure, which is correct for key 0
+    Bitboard attacks[2] = {0, 0}; // squares attacked by the pawns of each Color
+    Bitboard passed = 0;          // passed pawns of both sides
+    int mg = 0;                   // doubled, isolated, backward and passed pawn terms (white - black)
+    int eg = 0;
+};
+
+/**
+ * Small pawn hash table, one per search thread so it needs no locking.
+ * Entries are replaced on every miss.
+ */
+class PawnTable {
+private:
+    std::vector<PawnEntry> entries;
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+
+public:
+    explicit PawnTable(size_t count = 1 << 13);
+
+    static PawnEntry compute(Board &bd);
+    const PawnEntry &probe(Board &bd);
+    void resetStats();
+    uint64_t probeCount() const { return probes; }
+    uint64_t hitCount() const { return hits; }
+};
+
+int kingShelter(Board &bd, bool white);
+
+#endif // PAWNS_H
@@ -0,0 +1,136 @@
+#include "perft.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+Perft::Perft(size_t hash_mb)
+{
+    if (hash_mb > 0)
+        table.resize(hash_mb * 1024 * 1024 / sizeof(Entry));
+}
+
+uint64_t Perft::count(Board &bd, int depth)
+{
+    if (depth == 0)
+        return 1;
+
+    Entry *entry = nullptr;
+    if (!table.empty())
+    {
+        entry = &table[bd.getKey() % table.size()];
+        if (entry->key == bd.getKey() && entry->depth == depth)
+            return entry->nodes;
+    }
+
+    MoveList moves;
+    bd.allMoves(moves);
+    uint64_t nodes = 0;
+    if (depth == 1)
+        nodes = moves.size(); // the generator is legal, leaves need no make/undo
+    else
+    {
+        for (Move move : moves)
+        {
+            bd.movePiece(move);
+            nodes += count(bd, depth - 1);
+            bd.undoMove();
+        }
+    }
+
+    if (entry)
+        *entry = {bd.getKey(), nodes, depth};
+    return nodes;
+}
+
+uint64_t Perft::run(Board &bd, int depth)
+{
+    return count(bd, depth);
+}
+
+/**
+ * @brief print the node count below every root move, then the total and speed
+ */
+uint64_t Perft::divide(Board &bd, int depth)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    MoveList moves;
+    bd.allMoves(moves);
+    uint64_t total = 0;
+    for (Move move : moves)
+    {
+        bd.movePiece(move);
+        uint64_t nodes = depth > 1 ? count(bd, depth - 1) : 1;
+        bd.undoMove();
+        std::cout << Board::descUci(move) << ": " << nodes << "\n";
+        total += nodes;
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "\nnodes: " << total << "\n";
+    std::cout << "time : " << elapsed << " s" << "\n";
+    std::cout << "nps  : " << uint64_t(total / std::max(elapsed, 1e-9)) << "\n";
+    return total;
+}
+
+/**
+ * @brief run an EPD file of known counts, lines look like
+ * "<fen> ;D1 20 ;D2 400 ;D3 8902"
+ * @param max_depth deeper counts in the file are skipped
+ * @return true if every count matched
+ */
+bool Perft::suite(const std::string &path, int max_depth)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cout << "cannot open " << path << "\n";
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t total = 0;
+    int passed = 0, failed = 0;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        size_t sep = line.find(';');
+        if (line.empty() || line[0] == '#' || sep == std::string::npos)
+            continue;
+
+        Board bd(line.substr(0, sep));
+        std::istringstream counts(line.substr(sep));
+        std::string field;
+        while (std::getline(counts, field, ';'))
+        {
+            std::istringstream entry(field);
+            std::string name;
+            uint64_t expected;
+            if (!(entry >> name >> expected) || name.size() < 2 || name[0] != 'D')
+                continue;
+            int depth = std::stoi(name.substr(1));
+            if (depth > max_depth)
+                continue;
+
+            uint64_t nodes = count(bd, depth);
+            total += nodes;
+            if (nodes == expected)
+                passed++;
+            else
+            {
+                failed++;
+                std::cout << "FAIL " << line.substr(0, sep) << " depth " << depth << ": " << nodes
+                          << " expected " << expected << "\n";
+            }
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "passed: " << passed << ", failed: " << failed << "\n";
+    std::cout << "nodes: " << total << "\n";
+    std::cout << "time : " << elapsed << " s" << "\n";
+    std::cout << "nps  : " << uint64_t(total / std::max(elapsed, 1e-9)) << "\n";
+    return failed == 0;
+}
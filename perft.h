@@ -0,0 +1,33 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "board.h"
+
+/**
+ * Move generator test and benchmark: counts the leaf nodes of the legal
+ * move tree to a fixed depth.
+ */
+class Perft {
+private:
+    struct Entry {
+        uint64_t key;
+        uint64_t nodes;
+        int depth;
+    };
+
+    std::vector<Entry> table; // subtree counts, empty: no hashing
+
+    uint64_t count(Board &bd, int depth);
+
+public:
+    explicit Perft(size_t hash_mb = 0);
+
+    uint64_t run(Board &bd, int depth);
+    uint64_t divide(Board &bd, int depth);
+    bool suite(const std::string &path, int max_depth);
+};
+
+#endif // PERFT_H
@@ -0,0 +1,19 @@
+#ifndef POSITIONS_H
+#define POSITIONS_H
+
+/**
+ * Positions the speed measurements run on (evalbench, bench_micro): the
+ * start position, the usual perft test positions with castling, en passant
+ * and promotions, a quiet middlegame and a side in check.
+ */
+inline constexpr const char *SAMPLE_FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "4k3/8/8/8/8/8/3q4/4K3 w - - 0 1", // in check
+};
+
+#endif // POSITIONS_H
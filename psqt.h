@@ -0,0 +1,114 @@
+#ifndef PSQT_H
+#define PSQT_H
+
+#include <array>
+#include "bitboard.h"
+
+/*
+ * Material and piece-square values in centipawns (the Simplified
+ * Evaluation Function tables). Tables are written from white's side with
+ * A8 first, which is the Board square order; black reads them mirrored.
+ * Only the king has a separate endgame table, the score is tapered
+ * between the two by the remaining material (PHASE).
+ */
+
+constexpr int PIECE_VALUES[6] = {100, 320, 330, 500, 900, 0}; // indexed by Piece
+constexpr int PHASE[6] = {0, 1, 1, 2, 4, 0};                   // 24: all pieces on board
+constexpr int MAX_PHASE = 24;
+
+constexpr int PST_MG[6][64] = {
+    { // pawn
+      0,  0,  0,  0,  0,  0,  0,  0,
+     50, 50, 50, 50, 50, 50, 50, 50,
+     10, 10, 20, 30, 30, 20, 10, 10,
+      5,  5, 10, 25, 25, 10,  5,  5,
+      0,  0,  0, 20, 20,  0,  0,  0,
+      5, -5,-10,  0,  0,-10, -5,  5,
+      5, 10, 10,-20,-20, 10, 10,  5,
+      0,  0,  0,  0,  0,  0,  0,  0},
+    { // knight
+    -50,-40,-30,-30,-30,-30,-40,-50,
+    -40,-20,  0,  0,  0,  0,-20,-40,
+    -30,  0, 10, 15, 15, 10,  0,-30,
+    -30,  5, 15, 20, 20, 15,  5,-30,
+    -30,  0, 15, 20, 20, 15,  0,-30,
+    -30,  5, 10, 15, 15, 10,  5,-30,
+    -40,-20,  0,  5,  5,  0,-20,-40,
+    -50,-40,-30,-30,-30,-30,-40,-50},
+    { // bishop
+    -20,-10,-10,-10,-10,-10,-10,-20,
+    -10,  0,  0,  0,  0,  0,  0,-10,
+    -10,  0,  5, 10, 10,  5,  0,-10,
+    -10,  5,  5, 10, 10,  5,  5,-10,
+    -10,  0, 10, 10, 10, 10,  0,-10,
+    -10, 10, 10, 10, 10, 10, 10,-10,
+    -10,  5,  0,  0,  0,  0,  5,-10,
+    -20,-10,-10,-10,-10,-10,-10,-20},
+    { // rook
+      0,  0,  0,  0,  0,  0,  0,  0,
+      5, 10, 10, 10, 10, 10, 10,  5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+      0,  0,  0,  5,  5,  0,  0,  0},
+    { // queen
+    -20,-10,-10, -5, -5,-10,-10,-20,
+    -10,  0,  0,  0,  0,  0,  0,-10,
+    -10,  0,  5,  5,  5,  5,  0,-10,
+     -5,  0,  5,  5,  5,  5,  0, -5,
+      0,  0,  5,  5,  5,  5,  0, -5,
+    -10,  5,  5,  5,  5,  5,  0,-10,
+    -10,  0,  5,  0,  0,  0,  0,-10,
+    -20,-10,-10, -5, -5,-10,-10,-20},
+    { // king
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -20,-30,-30,-40,-40,-30,-30,-20,
+    -10,-20,-20,-20,-20,-20,-20,-10,
+     20, 20,  0,  0,  0,  0, 20, 20,
+     20, 30, 10,  0,  0, 10, 30, 20}};
+
+constexpr int KING_EG[64] = {
+    -50,-40,-30,-20,-20,-30,-40,-50,
+    -30,-20,-10,  0,  0,-10,-20,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-30,  0,  0,  0,  0,-30,-30,
+    -50,-30,-30,-30,-30,-30,-30,-50};
+
+/**
+ * Value of a piece on a square, signed from white's point of view
+ * (black pieces count negative), for both game phases.
+ */
+struct Psqt {
+    int mg[2][6][64]; // [Color][Piece][square]
+    int eg[2][6][64];
+};
+
+constexpr Psqt makePsqt()
+{
+    Psqt t{};
+    for (int p = PAWN; p <= KING; p++)
+    {
+        for (int sq = 0; sq < 64; sq++)
+        {
+            int mg = PIECE_VALUES[p] + PST_MG[p][sq];
+            int eg = PIECE_VALUES[p] + (p == KING ? KING_EG[sq] : PST_MG[p][sq]);
+            t.mg[WHITE][p][sq] = mg;
+            t.eg[WHITE][p][sq] = eg;
+            t.mg[BLACK][p][sq ^ 56] = -mg;
+            t.eg[BLACK][p][sq ^ 56] = -eg;
+        }
+    }
+    return t;
+}
+
+constexpr Psqt PSQT = makePsqt();
+
+#endif // PSQT_H
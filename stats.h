@@ -0,0 +1,82 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Counter written by one search thread and read by the main thread while
+ * the search runs. Relaxed loads and stores compile to plain moves: no
+ * lock prefix as with fetch_add, since only the owner ever writes.
+ */
+class Counter {
+private:
+    std::atomic<uint64_t> value{0};
+
+public:
+    Counter() = default;
+    Counter(const Counter &other) : value(other.get()) {}
+    Counter &operator=(const Counter &other)
+    {
+        set(other.get());
+        return *this;
+    }
+    Counter &operator=(uint64_t v)
+    {
+        set(v);
+        return *this;
+    }
+    operator uint64_t() const { return get(); }
+
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+    void set(uint64_t v) { value.store(v, std::memory_order_relaxed); }
+    Counter &operator++()
+    {
+        set(get() + 1);
+        return *this;
+    }
+    uint64_t operator++(int)
+    {
+        uint64_t old = get();
+        set(old + 1);
+        return old;
+    }
+    void raise(uint64_t v)
+    {
+        if (v > get())
+            set(v);
+    }
+};
+
+#ifndef NO_STATS
+
+/**
+ * Search shape counters of one thread, on cache lines of their own so that
+ * threads counting side by side do not invalidate each other.
+ */
+struct alignas(64) SearchStats {
+    Counter qnodes;        // quiescence nodes, also counted in the thread's nodes
+    Counter cutoffs;       // beta cutoffs in the main search
+    Counter first_cutoffs; // of those, on the first move searched
+    Counter tt_probes;
+    Counter tt_hits;
+    Counter seldepth;      // deepest ply reached, quiescence included
+    Counter reductions;    // moves searched with a late move reduction
+    Counter researches;    // reduced or zero-window searches repeated in full
+
+    void reset() { *this = SearchStats(); }
+};
+
+#define STAT(...) __VA_ARGS__
+
+#else // NO_STATS: counters and every STAT() statement compile away
+
+struct SearchStats {
+    void reset() {}
+};
+
+#define STAT(...)
+
+#endif
+
+#endif // STATS_H
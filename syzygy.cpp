@@ -0,0 +1,116 @@
+#include "syzygy.h"
+#include <iostream>
+
+#ifdef USE_SYZYGY
+#include "tbprobe.h"
+
+// Fathom numbers squares from a1, the board from a8: a vertical flip
+static uint64_t toFathom(Bitboard b)
+{
+    return __builtin_bswap64(b);
+}
+
+static TablebaseResult fromFathom(unsigned int wdl)
+{
+    if (wdl == TB_WIN)
+        return WDL_WIN;
+    if (wdl == TB_LOSS)
+        return WDL_LOSS;
+    return WDL_DRAW;
+}
+
+/**
+ * @brief load every table found in path (directories separated by ':')
+ * @return false if no table was found
+ */
+bool Syzygy::init(const std::string &path)
+{
+    static std::string loaded;
+    if (path == loaded)
+        return TB_LARGEST > 0;
+    if (!tb_init(path.c_str()))
+        return false;
+    loaded = path;
+    return TB_LARGEST > 0;
+}
+
+int Syzygy::largest()
+{
+    return TB_LARGEST;
+}
+
+/**
+ * @brief win/draw/loss for the side on move, assuming the fifty-move
+ * counter was just reset
+ * @return false if the position is not in the tables (too many pieces,
+ * castling rights, missing file)
+ */
+bool Syzygy::probeWdl(Board &bd, TablebaseResult &result)
+{
+    if (bd.pieceCount() > static_cast<int>(TB_LARGEST) || bd.castleRights())
+        return false;
+    int ep = bd.enpassSquare();
+    unsigned int wdl = tb_probe_wdl(toFathom(bd.colorSet(true)), toFathom(bd.colorSet(false)),
+                                    toFathom(bd.pieceSet(KING)), toFathom(bd.pieceSet(QUEEN)),
+                                    toFathom(bd.pieceSet(ROOK)), toFathom(bd.pieceSet(BISHOP)),
+                                    toFathom(bd.pieceSet(KNIGHT)), toFathom(bd.pieceSet(PAWN)),
+                                    0, 0, ep == -1 ? 0 : ep ^ 56, bd.onMove());
+    if (wdl == TB_RESULT_FAILED)
+        return false;
+    result = fromFathom(wdl);
+    return true;
+}
+
+/**
+ * @brief move that keeps the best result and, within it, the best distance
+ * to a zeroing move (DTZ)
+ * @param dtz plies to the next capture or pawn move of that line
+ * @return NO_MOVE if the position is not in the tables or has no moves
+ */
+Move Syzygy::probeRoot(Board &bd, TablebaseResult &result, int &dtz)
+{
+    if (bd.pieceCount() > static_cast<int>(TB_LARGEST) || bd.castleRights())
+        return NO_MOVE;
+    int ep = bd.enpassSquare();
+    unsigned int res = tb_probe_root(toFathom(bd.colorSet(true)), toFathom(bd.colorSet(false)),
+                                     toFathom(bd.pieceSet(KING)), toFathom(bd.pieceSet(QUEEN)),
+                                     toFathom(bd.pieceSet(ROOK)), toFathom(bd.pieceSet(BISHOP)),
+                                     toFathom(bd.pieceSet(KNIGHT)), toFathom(bd.pieceSet(PAWN)),
+                                     0, 0, ep == -1 ? 0 : ep ^ 56, bd.onMove(), nullptr);
+    if (res == TB_RESULT_FAILED || res == TB_RESULT_CHECKMATE || res == TB_RESULT_STALEMATE)
+        return NO_MOVE;
+
+    // LERF squares: file = sq & 7, rank = sq >> 3
+    unsigned int from = TB_GET_FROM(res), to = TB_GET_TO(res);
+    std::string uci = {char('a' + (from & 7)), char('1' + (from >> 3)), char('a' + (to & 7)), char('1' + (to >> 3))};
+    if (TB_GET_PROMOTES(res) != TB_PROMOTES_NONE)
+        uci += " qrbn"[TB_GET_PROMOTES(res)];
+    result = fromFathom(TB_GET_WDL(res));
+    dtz = TB_GET_DTZ(res);
+    return bd.parseUci(uci);
+}
+
+#else
+
+bool Syzygy::init(const std::string &path)
+{
+    std::cerr << "no Syzygy support in this build (make syzygy FATHOM=<dir>), ignoring " << path << "\n";
+    return false;
+}
+
+int Syzygy::largest()
+{
+    return 0;
+}
+
+bool Syzygy::probeWdl(Board &, TablebaseResult &)
+{
+    return false;
+}
+
+Move Syzygy::probeRoot(Board &, TablebaseResult &, int &)
+{
+    return NO_MOVE;
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef SYZYGY_H
+#define SYZYGY_H
+
+#include <string>
+#include "board.h"
+
+enum TablebaseResult {
+    WDL_LOSS = -1,
+    WDL_DRAW = 0, // also wins and losses spoiled by the fifty-move rule
+    WDL_WIN = 1
+};
+
+/**
+ * Syzygy endgame tablebases. Probing is done by the Fathom library, which
+ * memory-maps the .rtbw/.rtbz files; it is linked in by `make syzygy
+ * FATHOM=<dir>`. Without it every probe fails and the search runs as if no
+ * tables were present.
+ *
+ * The tables are process-wide: every Engine shares the files of the last
+ * successful init.
+ *
+ * The Fathom path is unverified: it has not been built or probed against real
+ * tables, as the tree bundles neither Fathom nor any .rtbw/.rtbz file.
+ */
+class Syzygy {
+public:
+    static bool init(const std::string &path);
+    static int largest();
+    static bool probeWdl(Board &bd, TablebaseResult &result);
+    static Move probeRoot(Board &bd, TablebaseResult &result, int &dtz);
+};
+
+#endif // SYZYGY_H
@@ -0,0 +1,160 @@
+#include "tt.h"
+#include "board.h"
+#include <algorithm>
+#include <new>
+
+TranspositionTable::TranspositionTable(size_t mb) : buckets(nullptr), bucket_count(0), age(0)
+{
+    resize(mb);
+}
+
+TranspositionTable::~TranspositionTable()
+{
+    delete[] buckets;
+}
+
+/**
+ * @brief reallocate the table, all stored results are lost
+ * @param mb size in megabytes, at least one bucket is kept
+ * @return false if the memory is not available; the old table stays
+ */
+bool TranspositionTable::resize(size_t mb)
+{
+    size_t count = std::max<size_t>(1, mb * 1024 * 1024 / sizeof(Bucket));
+    Bucket *table = new (std::nothrow) Bucket[count];
+    if (table == nullptr)
+        return false;
+    delete[] buckets;
+    buckets = table;
+    bucket_count = count;
+    clear();
+    return true;
+}
+
+void TranspositionTable::clear()
+{
+    for (size_t i = 0; i < bucket_count; i++)
+    {
+        for (Entry &entry : buckets[i].entries)
+        {
+            entry.check.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    age = 0;
+}
+
+/**
+ * @brief start a new search: entries from older searches become preferred
+ * victims for replacement
+ */
+void TranspositionTable::newSearch()
+{
+    age = (age + 1) & 63;
+}
+
+/**
+ * @brief permille of sampled entries written in the current search, as
+ * reported by UCI hashfull
+ */
+int TranspositionTable::hashfull() const
+{
+    int used = 0, sampled = 0;
+    for (size_t i = 0; i < bucket_count && sampled < 1000; i++)
+    {
+        for (const Entry &entry : buckets[i].entries)
+        {
+            uint64_t data = entry.data.load(std::memory_order_relaxed);
+            used += data != 0 && (data >> 42) == age;
+            sampled++;
+        }
+    }
+    return used * 1000 / sampled;
+}
+
+TranspositionTable::Bucket &TranspositionTable::bucketFor(uint64_t key)
+{
+    // multiply-shift maps the key onto any bucket count, not only powers of two
+    return buckets[(unsigned __int128)key * bucket_count >> 64];
+}
+
+/*
+ * data layout: move 16 bits | score 16 bits | depth 8 bits | bound 2 bits | age 6 bits
+ * depth is stored +1 so that a used entry is never all zeros
+ */
+uint64_t TranspositionTable::pack(uint16_t move, int score, int depth, Bound bound, uint8_t age)
+{
+    return uint64_t(move) | uint64_t(uint16_t(int16_t(score))) << 16 |
+           uint64_t(uint8_t(depth + 1)) << 32 | uint64_t(bound) << 40 | uint64_t(age) << 42;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTData &out)
+{
+    for (Entry &entry : bucketFor(key).entries)
+    {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if ((entry.check.load(std::memory_order_relaxed) ^ data) != key || data == 0)
+            continue;
+        out.move = uint16_t(data);
+        out.score = int16_t(data >> 16);
+        out.depth = int(uint8_t(data >> 32)) - 1;
+        out.bound = Bound((data >> 40) & 3);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief store a search result; an entry for the same key is overwritten,
+ * otherwise the shallowest entry weighted by age is replaced
+ */
+void TranspositionTable::store(uint64_t key, uint16_t move, int score, int depth, Bound bound)
+{
+    Entry *victim = nullptr;
+    int victim_value = 1 << 30;
+    for (Entry &entry : bucketFor(key).entries)
+    {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if (data == 0 || (entry.check.load(std::memory_order_relaxed) ^ data) == key)
+        {
+            victim = &entry;
+            if (data != 0 && move == 0)
+                move = uint16_t(data); // keep the old best move
+            break;
+        }
+        int entry_depth = int(uint8_t(data >> 32)) - 1;
+        int entry_age = (age - int(data >> 42)) & 63;
+        int value = entry_depth - 4 * entry_age;
+        if (value < victim_value)
+        {
+            victim = &entry;
+            victim_value = value;
+        }
+    }
+
+    uint64_t data = pack(move, score, depth, bound, age);
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+/**
+ * @brief mate and tablebase scores are stored relative to the node, not the
+ * root, so a hit at another ply reports the right distance to the result
+ */
+int TranspositionTable::scoreToTT(int score, int ply)
+{
+    if (score >= TB_WIN_SCORE - MAX_PLY)
+        return score + ply;
+    if (score <= -TB_WIN_SCORE + MAX_PLY)
+        return score - ply;
+    return score;
+}
+
+int TranspositionTable::scoreFromTT(int score, int ply)
+{
+    if (score >= TB_WIN_SCORE - MAX_PLY)
+        return score - ply;
+    if (score <= -TB_WIN_SCORE + MAX_PLY)
+        return score + ply;
+    return score;
+}
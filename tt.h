@@ -0,0 +1,68 @@
+#ifndef TT_H
+#define TT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+enum Bound : uint8_t {
+    BOUND_NONE,
+    BOUND_UPPER, // score <= alpha, real score is at most this
+    BOUND_LOWER, // score >= beta, real score is at least this
+    BOUND_EXACT
+};
+
+struct TTData {
+    uint16_t move; // Move, NO_MOVE: none
+    int score;
+    int depth;
+    Bound bound;
+};
+
+/**
+ * Fixed-size hash table of search results shared by all search threads.
+ *
+ * Entries are two relaxed 64-bit atomics: the packed data and key ^ data.
+ * A reader accepts an entry only if both words still XOR to its key, so
+ * a torn write from another thread reads as a miss instead of garbage
+ * and no locks are needed.
+ */
+class TranspositionTable {
+private:
+    struct Entry {
+        std::atomic<uint64_t> check; // key ^ data
+        std::atomic<uint64_t> data;
+    };
+
+    static constexpr int BUCKET_SIZE = 4;
+
+    struct alignas(64) Bucket {
+        Entry entries[BUCKET_SIZE];
+    };
+
+    Bucket *buckets;
+    size_t bucket_count;
+    uint8_t age; // 6 bits, bumped by newSearch()
+
+    Bucket &bucketFor(uint64_t key);
+    static uint64_t pack(uint16_t move, int score, int depth, Bound bound, uint8_t age);
+
+public:
+    explicit TranspositionTable(size_t mb = 16);
+    ~TranspositionTable();
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+    bool resize(size_t mb);
+    void clear();
+    void newSearch();
+    int hashfull() const;
+
+    bool probe(uint64_t key, TTData &out);
+    void store(uint64_t key, uint16_t move, int score, int depth, Bound bound);
+
+    static int scoreToTT(int score, int ply);
+    static int scoreFromTT(int score, int ply);
+};
+
+#endif // TT_H
@@ -0,0 +1,269 @@
+#include "uci.h"
+#include <algorithm>
+#include <cctype>
+
+static std::vector<std::string> withUci(std::vector<std::string> flags)
+{
+    flags.push_back("uci");
+    return flags;
+}
+
+Uci::Uci(const std::vector<std::string> &flags) : engine("", withUci(flags))
+{
+}
+
+Uci::~Uci()
+{
+    stopSearch();
+}
+
+/**
+ * @brief stop a running search and wait until its bestmove is out
+ */
+void Uci::stopSearch()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+    }
+    cv.notify_all();
+    engine.stopSearch();
+    if (searcher.joinable())
+        searcher.join();
+}
+
+/**
+ * @brief position startpos|fen <fen> [moves <m1> <m2> ...]
+ * moves are played on the board one by one with movePiece; a bad fen or
+ * move is reported and the previous position kept
+ */
+void Uci::position(std::istringstream &is)
+{
+    std::string token, fen;
+    is >> token;
+    if (token == "fen")
+    {
+        while (is >> token && token != "moves")
+            fen += token + " ";
+    }
+    else if (token != "startpos" || (is >> token && token != "moves"))
+    {
+        Engine::send("info string invalid position command");
+        return;
+    }
+
+    Board next;
+    try
+    {
+        next = Board(fen);
+    }
+    catch (const std::exception &)
+    {
+        Engine::send("info string invalid fen " + fen);
+        return;
+    }
+    while (is >> token)
+    {
+        Move move = next.parseUci(token);
+        if (move == NO_MOVE)
+        {
+            Engine::send("info string illegal move " + token + ", position not changed");
+            return;
+        }
+        next.movePiece(move);
+    }
+    bd = next;
+}
+
+/**
+ * @brief go [depth N] [nodes N] [movetime ms] [wtime ms] [btime ms]
+ * [winc ms] [binc ms] [movestogo N] [infinite]
+ */
+void Uci::go(std::istringstream &is)
+{
+    stopSearch();
+
+    SearchLimits limits;
+    int wtime = 0, btime = 0, winc = 0, binc = 0;
+    bool go_infinite = false;
+    std::string token;
+    while (is >> token)
+    {
+        if (token == "depth")
+            is >> limits.depth;
+        else if (token == "nodes")
+            is >> limits.nodes;
+        else if (token == "movetime")
+            is >> limits.movetime;
+        else if (token == "wtime")
+            is >> wtime;
+        else if (token == "btime")
+            is >> btime;
+        else if (token == "winc")
+            is >> winc;
+        else if (token == "binc")
+            is >> binc;
+        else if (token == "movestogo")
+            is >> limits.movestogo;
+        else if (token == "infinite")
+            go_infinite = true;
+    }
+    limits.time = bd.onMove() ? wtime : btime;
+    limits.inc = bd.onMove() ? winc : binc;
+
+    engine.setPosition(bd);
+    Move book_move = go_infinite ? NO_MOVE : engine.bookMove();
+    if (book_move != NO_MOVE)
+    {
+        Engine::send("bestmove " + Board::descUci(book_move));
+        return;
+    }
+    TablebaseResult wdl;
+    int dtz;
+    Move tb_move = go_infinite ? NO_MOVE : engine.tablebaseMove(wdl, dtz);
+    if (tb_move != NO_MOVE)
+    {
+        std::string result = wdl == WDL_WIN ? "win" : wdl == WDL_LOSS ? "loss" : "draw";
+        Engine::send("info string tablebase " + result + " dtz " + std::to_string(dtz) + "\n" +
+                     "bestmove " + Board::descUci(tb_move));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        infinite = go_infinite;
+        stopped = false;
+    }
+    engine.startSearch(limits);
+    searcher = std::thread([this] {
+        const SearchThread &best = engine.finishSearch();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return !infinite || stopped; });
+        }
+        std::string move = best.pv.empty() ? "0000" : Board::descUci(best.pv[0]);
+        Engine::send("bestmove " + move);
+    });
+}
+
+/**
+ * @brief value of a spin option clamped to [min, max]
+ * @return false (with an info string) if it is not a number
+ */
+static bool spinValue(const std::string &name, const std::string &value, int min, int max, int &result)
+{
+    size_t digits = value[0] == '-' || value[0] == '+' ? 1 : 0;
+    if (digits == value.size() || !std::all_of(value.begin() + digits, value.end(), ::isdigit))
+    {
+        Engine::send("info string invalid value " + value + " for " + name);
+        return false;
+    }
+    long long number;
+    try
+    {
+        number = std::stoll(value);
+    }
+    catch (const std::out_of_range &)
+    {
+        number = value[0] == '-' ? min : max;
+    }
+    result = int(std::clamp<long long>(number, min, max));
+    return true;
+}
+
+/**
+ * @brief setoption name Hash|Threads value N, name BookFile value <path>,
+ * name BookBest value true|false, name SyzygyPath value <dirs>, name SyzygyProbeLimit value N;
+ * numbers are clamped to the range announced in the uci reply
+ */
+void Uci::setOption(std::istringstream &is)
+{
+    std::string token, name, value;
+    is >> token >> name >> token >> value;
+    if (value.empty())
+        return;
+    stopSearch();
+    int number;
+    if (name == "Hash")
+    {
+        if (spinValue(name, value, 1, 65536, number) && !engine.setHash(number))
+            Engine::send("info string cannot allocate " + std::to_string(number) + " MB, hash size unchanged");
+    }
+    else if (name == "Threads")
+    {
+        if (spinValue(name, value, 1, 256, number))
+            engine.setThreads(number);
+    }
+    else if (name == "BookFile")
+        engine.setBook(value);
+    else if (name == "BookBest")
+    {
+        if (value == "true" || value == "false")
+            engine.setBookBest(value == "true");
+        else
+            Engine::send("info string invalid value " + value + " for " + name);
+    }
+    else if (name == "SyzygyPath")
+        engine.setSyzygy(value);
+    else if (name == "SyzygyProbeLimit")
+    {
+        if (spinValue(name, value, 0, 7, number))
+            engine.setSyzygyLimit(number);
+    }
+}
+
+/**
+ * @brief handle one line from the GUI
+ * @return false on quit
+ */
+bool Uci::command(const std::string &line)
+{
+    std::istringstream is(line);
+    std::string token;
+    is >> token;
+
+    if (token == "uci")
+    {
+        Engine::send("id name chess-engine\n"
+                     "id author maciej-janusz\n"
+                     "option name Hash type spin default 16 min 1 max 65536\n"
+                     "option name Threads type spin default 1 min 1 max 256\n"
+                     "option name BookFile type string default <empty>\n"
+                     "option name BookBest type check default false\n"
+                     "option name SyzygyPath type string default <empty>\n"
+                     "option name SyzygyProbeLimit type spin default 7 min 0 max 7\n"
+                     "uciok");
+    }
+    else if (token == "isready")
+        Engine::send("readyok");
+    else if (token == "ucinewgame")
+    {
+        stopSearch();
+        engine.clearHash();
+    }
+    else if (token == "position")
+    {
+        stopSearch();
+        position(is);
+    }
+    else if (token == "go")
+        go(is);
+    else if (token == "stop")
+        stopSearch();
+    else if (token == "setoption")
+        setOption(is);
+    else if (token == "quit")
+        return false;
+    return true;
+}
+
+void Uci::loop(std::istream &in)
+{
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (!command(line))
+            break;
+    }
+    stopSearch();
+}
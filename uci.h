@@ -0,0 +1,42 @@
+#ifndef UCI_H
+#define UCI_H
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "engine.h"
+
+/**
+ * Long-lived UCI session: one Engine, with its transposition table and
+ * thread pool, serves every position the GUI sends. A search runs on its
+ * own thread so that stop and isready are answered while it thinks.
+ */
+class Uci {
+private:
+    Engine engine;
+    Board bd; // position from the last "position" command
+    std::thread searcher;
+
+    // "go infinite" holds bestmove back until "stop" even if the search ends
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool infinite = false;
+    bool stopped = false;
+
+    void position(std::istringstream &is);
+    void go(std::istringstream &is);
+    void setOption(std::istringstream &is);
+    void stopSearch();
+
+public:
+    explicit Uci(const std::vector<std::string> &flags);
+    ~Uci();
+
+    bool command(const std::string &line);
+    void loop(std::istream &in);
+};
+
+#endif // UCI_H
@@ -0,0 +1,46 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+#include <array>
+
+/*
+ * Zobrist keys for Board::getKey(), generated at compile time.
+ * Layout: [color][piece][square] for pieces, then the side to move,
+ * one key per castles bit and one per en passant file.
+ */
+
+constexpr uint64_t splitMix64(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+struct ZobristKeys {
+    uint64_t pieces[2][6][64]; // [Color][Piece][square]
+    uint64_t side;             // white on move
+    uint64_t castles[4];       // one per bit of Board::castles
+    uint64_t enpass[8];        // en passant file
+};
+
+constexpr ZobristKeys makeZobristKeys()
+{
+    ZobristKeys keys{};
+    uint64_t state = 0x5EEDC0DEULL;
+    for (auto &color : keys.pieces)
+        for (auto &piece : color)
+            for (auto &key : piece)
+                key = splitMix64(state);
+    keys.side = splitMix64(state);
+    for (auto &key : keys.castles)
+        key = splitMix64(state);
+    for (auto &key : keys.enpass)
+        key = splitMix64(state);
+    return keys;
+}
+
+constexpr ZobristKeys ZOBRIST = makeZobristKeys();
+
+#endif // ZOBRIST_H